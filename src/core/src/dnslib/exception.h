@@ -1,69 +0,0 @@
-/**
- * DNS Exception
- *
- * Copyright (c) 2014 Michal Nezerka
- * All rights reserved.
- *
- * Developed by: Michal Nezerka
- *               https://github.com/mnezerka/
- *               mailto:michal.nezerka@gmail.com
- *
- * Permission is hereby granted, free of charge, to any person obtaining
- * a copy of this software and associated documentation files
- * (the "Software"), to deal with the Software without restriction,
- * including without limitation the rights to use, copy, modify, merge,
- * publish, distribute, sublicense, and/or sell copies of the Software,
- * and to permit persons to whom the Software is furnished to do so,
- * subject to the following conditions:
- *
- *  * Redistributions of source code must retain the above copyright
- *    notice, this list of conditions and the following disclaimers.
- *  * Redistributions in binary form must reproduce the above copyright
- *    notice, this list of conditions and the following disclaimers in the
- *    documentation and/or other materials provided with the distribution.
- *  * Neither the name of Michal Nezerka, nor the names of its contributors
- *    may be used to endorse or promote products derived from this Software
- *    without specific prior written permission. 
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
- * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
- * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
- * IN NO EVENT SHALL THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR
- * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
- * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
- * SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE SOFTWARE.
- *
- */
-
-#ifndef _DNS_EXCEPTION_H
-#define	_DNS_EXCEPTION_H
-
-#include <exception>
-#include <string>
-
-namespace dns {
-
-/**
- *  Exception class extends standard exception funtionality and adds it the text
- *  message to inform about the reason of the exception thrown.
- */
-class Exception : public std::exception {
-public:
-    // Constructor
-    // @param text Information text to be filled with the reasons of the exception
-    Exception(const std::string& text) : m_text(text) { }
-    Exception(const char *text) : m_text(text) { }
-    virtual ~Exception() throw() { }
-
-    // Returns the information text string
-    virtual const char* what() const throw()
-    {
-        return m_text.data();
-    }
-
-private:
-    std::string m_text;
-};
-}
-#endif	/* _DNS_EXCEPTION_H */
-
@@ -0,0 +1,509 @@
+#include "datagram_batch.hpp"
+#include "errno.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <sys/socket.h>
+    #include <sys/uio.h>
+    #include <netinet/in.h>
+    #include <netinet/udp.h>
+#endif
+
+namespace sockspp
+{
+
+static_assert(sizeof(sockaddr_storage) <= 128);
+
+#if defined(__linux__)
+// most datagrams in one message with UDP_SEGMENT (UDP_MAX_SEGMENTS)
+static constexpr size_t GSO_MAX_SEGMENTS = 64;
+// most bytes in one message with UDP_SEGMENT (an IPv4 udp payload)
+static constexpr size_t GSO_MAX_SIZE = 65507;
+
+// cmsg room for the UDP_GRO / UDP_SEGMENT sizes
+struct DatagramControl
+{
+    alignas(cmsghdr) uint8_t data[CMSG_SPACE(sizeof(int))];
+};
+
+// a message of sendmmsg(), one datagram or a run sent with UDP_SEGMENT
+struct DatagramRun
+{
+    size_t datagrams;
+    size_t iovecs; // per datagram
+    bool gso;
+};
+#endif // __linux__
+
+struct DatagramMessages
+{
+#if defined(__linux__)
+    std::vector<mmsghdr> headers; // recvmmsg(), one per entry
+    std::vector<iovec> iovecs;
+    std::vector<DatagramControl> controls;
+
+    std::vector<mmsghdr> send_headers; // sendmmsg(), one per message
+    std::vector<iovec> send_iovecs;
+    std::vector<DatagramControl> send_controls;
+    std::vector<DatagramRun> send_runs;
+#endif // __linux__
+};
+
+DatagramBatch::DatagramBatch(
+    size_t capacity,
+    size_t datagram_size,
+    size_t headroom
+)   : _buffer(new uint8_t[capacity * (headroom + datagram_size)])
+    , _entries(capacity)
+    , _messages(new DatagramMessages())
+    , _datagram_size(datagram_size)
+    , _headroom(headroom)
+    , _size(0)
+{
+    for (size_t i = 0; i < capacity; i++)
+    {
+        Entry& entry = _entries[i];
+        entry.slot = _buffer.get() + i * (headroom + datagram_size);
+        entry.data = entry.slot + headroom;
+        entry.size = 0;
+        entry.segment_size = 0;
+        entry.prefix_size = 0;
+        entry.address_length = 0;
+    }
+
+#if defined(__linux__)
+    _messages->headers.resize(capacity);
+    _messages->iovecs.resize(capacity);
+    _messages->controls.resize(capacity);
+#endif // __linux__
+}
+
+DatagramBatch::~DatagramBatch() = default;
+
+size_t DatagramBatch::get_capacity() const
+{
+    return _entries.size();
+}
+
+size_t DatagramBatch::get_size() const
+{
+    return _size;
+}
+
+void DatagramBatch::set_size(size_t size)
+{
+    if (size < _size)
+        _size = size;
+}
+
+void DatagramBatch::swap(size_t a, size_t b)
+{
+    std::swap(_entries[a], _entries[b]);
+}
+
+MemoryBuffer DatagramBatch::get_data(size_t idx) const
+{
+    const Entry& entry = _entries[idx];
+
+    return MemoryBuffer(
+        entry.data,
+        entry.size,
+        entry.slot + _headroom + _datagram_size - entry.data
+    );
+}
+
+void DatagramBatch::set_data(size_t idx, uint8_t* data, size_t size)
+{
+    _entries[idx].data = data;
+    _entries[idx].size = size;
+}
+
+size_t DatagramBatch::get_segment_size(size_t idx) const
+{
+    return _entries[idx].segment_size;
+}
+
+void DatagramBatch::set_prefix_size(size_t idx, size_t size)
+{
+    _entries[idx].prefix_size = size;
+}
+
+void* DatagramBatch::get_address(size_t idx)
+{
+    return _entries[idx].address;
+}
+
+int DatagramBatch::get_address_length(size_t idx) const
+{
+    return _entries[idx].address_length;
+}
+
+void DatagramBatch::set_address_length(size_t idx, int length)
+{
+    _entries[idx].address_length = length;
+}
+
+int DatagramBatch::recv_from(int fd)
+{
+    _size = 0;
+
+#if defined(__linux__)
+    for (size_t i = 0; i < _entries.size(); i++)
+    {
+        Entry& entry = _entries[i];
+        entry.data = entry.slot + _headroom;
+
+        iovec& iov = _messages->iovecs[i];
+        iov.iov_base = entry.data;
+        iov.iov_len = _datagram_size;
+
+        msghdr& msg = _messages->headers[i].msg_hdr;
+        msg = msghdr();
+        msg.msg_name = entry.address;
+        msg.msg_namelen = sizeof(entry.address);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = _messages->controls[i].data;
+        msg.msg_controllen = sizeof(_messages->controls[i].data);
+    }
+
+    int res = ::recvmmsg(
+        fd,
+        _messages->headers.data(),
+        static_cast<unsigned int>(_entries.size()),
+        0,
+        nullptr
+    );
+
+    if (res == -1)
+        return -1;
+
+    for (int i = 0; i < res; i++)
+    {
+        Entry& entry = _entries[i];
+        msghdr& msg = _messages->headers[i].msg_hdr;
+
+        entry.size = _messages->headers[i].msg_len;
+        entry.segment_size = 0;
+        entry.prefix_size = 0;
+        entry.address_length = msg.msg_namelen;
+
+#ifdef UDP_GRO
+        // only there if the socket has UDP_GRO on
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if (cmsg->cmsg_level != SOL_UDP || cmsg->cmsg_type != UDP_GRO)
+                continue;
+
+            int segment_size = 0;
+            memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+
+            if (segment_size > 0 && static_cast<size_t>(segment_size) < entry.size)
+                entry.segment_size = segment_size;
+        }
+#endif // UDP_GRO
+    }
+
+    _size = res;
+#else
+    while (_size < _entries.size())
+    {
+        Entry& entry = _entries[_size];
+        entry.data = entry.slot + _headroom;
+
+        socklen_t address_length = sizeof(entry.address);
+        int res = ::recvfrom(
+            fd,
+            reinterpret_cast<char*>(entry.data),
+            static_cast<int>(_datagram_size),
+            0,
+            reinterpret_cast<sockaddr*>(entry.address),
+            &address_length
+        );
+
+        if (res == -1)
+        {
+            if (_size)
+                break;
+
+            return -1;
+        }
+
+        entry.size = res;
+        entry.segment_size = 0;
+        entry.prefix_size = 0;
+        entry.address_length = address_length;
+        _size++;
+    }
+#endif // __linux__
+
+    return static_cast<int>(_size);
+}
+
+int DatagramBatch::send_to(int fd)
+{
+    return send_to(fd, 0, _size);
+}
+
+int DatagramBatch::send_to(int fd, size_t begin, size_t end, bool* gso)
+{
+    int sent = 0;
+
+    if (end > _size)
+        end = _size;
+
+#if defined(__linux__)
+    bool use_gso = gso && *gso;
+
+#ifndef UDP_SEGMENT
+    use_gso = false;
+#endif // UDP_SEGMENT
+
+    // upper bounds: one message and two buffers per datagram
+    size_t max_messages = 0;
+
+    for (size_t i = begin; i < end; i++)
+    {
+        const Entry& entry = _entries[i];
+
+        max_messages += entry.segment_size
+            ? (entry.size - entry.prefix_size + entry.segment_size - 1) / entry.segment_size
+            : 1;
+    }
+
+    if (_messages->send_headers.size() < max_messages)
+    {
+        _messages->send_headers.resize(max_messages);
+        _messages->send_iovecs.resize(max_messages * 2);
+        _messages->send_controls.resize(max_messages);
+        _messages->send_runs.resize(max_messages);
+    }
+
+    size_t messages = 0;
+    size_t iovecs = 0;
+
+    auto add_message = [&](const Entry& entry, size_t iovecs_per_datagram) -> msghdr& {
+        msghdr& msg = _messages->send_headers[messages].msg_hdr;
+        msg = msghdr();
+        msg.msg_name = const_cast<uint8_t*>(entry.address);
+        msg.msg_namelen = entry.address_length;
+        msg.msg_iov = &_messages->send_iovecs[iovecs];
+
+        _messages->send_runs[messages] = DatagramRun{ 0, iovecs_per_datagram, false };
+        messages++;
+
+        return msg;
+    };
+
+    auto add_buffer = [&](msghdr& msg, uint8_t* data, size_t size) {
+        _messages->send_iovecs[iovecs++] = iovec{ data, size };
+        msg.msg_iovlen++;
+    };
+
+    auto set_segment = [&](msghdr& msg, size_t datagram_size) {
+#ifdef UDP_SEGMENT
+        DatagramControl& control = _messages->send_controls[messages - 1];
+        msg.msg_control = control.data;
+        msg.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_UDP;
+        cmsg->cmsg_type = UDP_SEGMENT;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+
+        uint16_t segment = static_cast<uint16_t>(datagram_size);
+        memcpy(CMSG_DATA(cmsg), &segment, sizeof(segment));
+
+        _messages->send_runs[messages - 1].gso = true;
+#endif // UDP_SEGMENT
+    };
+
+    for (size_t i = begin; i < end;)
+    {
+        Entry& entry = _entries[i];
+
+        if (entry.segment_size)
+        {
+            // coalesced on reception, the prefix goes in front of every segment
+            size_t payload_size = entry.size - entry.prefix_size;
+            size_t datagram_size = entry.prefix_size + entry.segment_size;
+            size_t per_message = use_gso
+                ? std::clamp<size_t>(GSO_MAX_SIZE / datagram_size, 1, GSO_MAX_SEGMENTS)
+                : 1;
+
+            for (size_t offset = 0; offset < payload_size;)
+            {
+                msghdr& msg = add_message(entry, entry.prefix_size ? 2 : 1);
+                DatagramRun& run = _messages->send_runs[messages - 1];
+
+                while (offset < payload_size && run.datagrams < per_message)
+                {
+                    size_t size = std::min(entry.segment_size, payload_size - offset);
+
+                    if (entry.prefix_size)
+                        add_buffer(msg, entry.data, entry.prefix_size);
+
+                    add_buffer(msg, entry.data + entry.prefix_size + offset, size);
+                    offset += size;
+                    run.datagrams++;
+                }
+
+                if (run.datagrams > 1)
+                    set_segment(msg, datagram_size);
+            }
+
+            i++;
+            continue;
+        }
+
+        msghdr& msg = add_message(entry, 1);
+        DatagramRun& run = _messages->send_runs[messages - 1];
+        size_t total = entry.size;
+
+        add_buffer(msg, entry.data, entry.size);
+        run.datagrams = 1;
+        i++;
+
+        // the next datagrams of the same size to the same address,
+        // the last one of a run may be shorter
+        while (use_gso
+            && entry.size
+            && i < end
+            && run.datagrams < GSO_MAX_SEGMENTS)
+        {
+            const Entry& next = _entries[i];
+
+            if (next.segment_size
+                || !next.size
+                || next.size > entry.size
+                || total + next.size > GSO_MAX_SIZE
+                || next.address_length != entry.address_length
+                || memcmp(next.address, entry.address, entry.address_length) != 0)
+            {
+                break;
+            }
+
+            add_buffer(msg, next.data, next.size);
+            total += next.size;
+            run.datagrams++;
+            i++;
+
+            if (next.size < entry.size)
+                break;
+        }
+
+        if (run.datagrams > 1)
+            set_segment(msg, entry.size);
+    }
+
+    size_t idx = 0;
+
+    while (idx < messages)
+    {
+        int res = ::sendmmsg(
+            fd,
+            _messages->send_headers.data() + idx,
+            static_cast<unsigned int>(messages - idx),
+            0
+        );
+
+        if (res > 0)
+        {
+            for (size_t last = idx + res; idx < last; idx++)
+            {
+                sent += static_cast<int>(_messages->send_runs[idx].datagrams);
+            }
+
+            continue;
+        }
+
+        int error = sockerrno;
+
+        if ((error == SOCKSPP_EWOULDBLOCK) || (error == SOCKSPP_EAGAIN))
+            break;
+
+        const DatagramRun& run = _messages->send_runs[idx];
+
+        if (!run.gso)
+        {
+            idx++; // e.g. unreachable destination, the next ones may pass
+            continue;
+        }
+
+        // the run can't be segmented (e.g. larger than the path mtu),
+        // or the socket can't do it at all
+        if (gso && (error == EIO || error == ENOPROTOOPT || error == EOPNOTSUPP))
+            *gso = false;
+
+        const msghdr& msg = _messages->send_headers[idx].msg_hdr;
+        mmsghdr datagrams[GSO_MAX_SEGMENTS];
+
+        for (size_t d = 0; d < run.datagrams; d++)
+        {
+            msghdr& datagram = datagrams[d].msg_hdr;
+            datagram = msghdr();
+            datagram.msg_name = msg.msg_name;
+            datagram.msg_namelen = msg.msg_namelen;
+            datagram.msg_iov = msg.msg_iov + d * run.iovecs;
+            datagram.msg_iovlen = run.iovecs;
+        }
+
+        size_t done = 0;
+
+        while (done < run.datagrams)
+        {
+            res = ::sendmmsg(
+                fd,
+                datagrams + done,
+                static_cast<unsigned int>(run.datagrams - done),
+                0
+            );
+
+            if (res > 0)
+            {
+                done += res;
+                sent += res;
+            }
+            else if ((sockerrno == SOCKSPP_EWOULDBLOCK) || (sockerrno == SOCKSPP_EAGAIN))
+            {
+                return sent;
+            }
+            else
+            {
+                done++;
+            }
+        }
+
+        idx++;
+    }
+#else
+    for (size_t i = begin; i < end; i++)
+    {
+        const Entry& entry = _entries[i];
+
+        int res = ::sendto(
+            fd,
+            reinterpret_cast<const char*>(entry.data),
+            static_cast<int>(entry.size),
+            0,
+            reinterpret_cast<const sockaddr*>(entry.address),
+            entry.address_length
+        );
+
+        if (res != -1)
+            sent++;
+        else if ((sockerrno == SOCKSPP_EWOULDBLOCK) || (sockerrno == SOCKSPP_EAGAIN))
+            break;
+    }
+#endif // __linux__
+
+    return sent;
+}
+
+} // namespace sockspp
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "memory_buffer.hpp"
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+namespace sockspp
+{
+
+struct DatagramMessages;
+
+// Datagrams moved by one system call: recvmmsg()/sendmmsg() on Linux,
+// one recvfrom()/sendto() per datagram elsewhere. Every datagram has a
+// slot of its own with some headroom before the received data, so a
+// header can be put in front of the payload (or skipped) in place.
+// With the udp offloads of Linux, an entry may hold several datagrams
+// of one sender coalesced by the kernel (UDP_GRO), and runs of datagrams
+// of one size are sent with a single message (UDP_SEGMENT).
+class DatagramBatch
+{
+public:
+    DatagramBatch(size_t capacity, size_t datagram_size, size_t headroom = 0);
+    DatagramBatch(const DatagramBatch& other) = delete;
+    ~DatagramBatch();
+
+    size_t get_capacity() const;
+    size_t get_size() const;
+    void set_size(size_t size); // only shrinks, the last ones are dropped
+    void swap(size_t a, size_t b);
+
+    // the data of a datagram, it can be moved anywhere in its slot
+    MemoryBuffer get_data(size_t idx) const;
+    void set_data(size_t idx, uint8_t* data, size_t size);
+
+    // the datagrams of an entry coalesced on reception are cut in
+    // segments of this size (the last one may be shorter), 0 = one
+    // datagram. The first prefix_size bytes of the data are sent in
+    // front of every segment (e.g. a header put in the headroom)
+    size_t get_segment_size(size_t idx) const;
+    void set_prefix_size(size_t idx, size_t size);
+
+    // source of a received datagram, destination of one to send
+    void* get_address(size_t idx);
+    int get_address_length(size_t idx) const;
+    void set_address_length(size_t idx, int length);
+
+    // replaces the batch with up to capacity datagrams,
+    // -1 if nothing could be received (errno is set)
+    int recv_from(int fd);
+
+    // sends every datagram to its address, the ones refused by the
+    // socket are skipped, stops when the socket buffer is full
+    // returns the number of datagrams sent
+    // gso: with segmentation offload, sent again one by one when the
+    // kernel refuses a run, and turned off if the socket can't do it
+    int send_to(int fd);
+    int send_to(int fd, size_t begin, size_t end, bool* gso = nullptr); // [begin, end) only
+
+private:
+    struct Entry
+    {
+        uint8_t* slot;
+        uint8_t* data;
+        size_t size;
+        size_t segment_size; // coalesced datagrams (GRO), 0 = one
+        size_t prefix_size;  // in front of every segment
+        int address_length;
+        alignas(8) uint8_t address[128]; // sockaddr_storage
+    };
+
+    std::unique_ptr<uint8_t[]> _buffer; // left uninitialized, the unused
+                                        // space of the slots is never touched
+    std::vector<Entry> _entries;
+    std::unique_ptr<DatagramMessages> _messages; // system call arguments
+    size_t _datagram_size;
+    size_t _headroom;
+    size_t _size;
+
+}; // class DatagramBatch
+
+} // namespace sockspp
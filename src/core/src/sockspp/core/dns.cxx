@@ -0,0 +1,324 @@
+#include "dns.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+// compression pointers followed while reading one name at most
+#define SOCKSPP_DNS_MAX_POINTERS 16
+
+// wire length of a name, length octets and the root label included
+#define SOCKSPP_DNS_MAX_WIRE_NAME_LENGTH 255
+
+#define SOCKSPP_DNS_HEADER_SIZE 12
+#define SOCKSPP_DNS_CLASS_IN 1
+
+namespace sockspp
+{
+
+static inline uint16_t _get16(const uint8_t* data)
+{
+    return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+
+static inline uint32_t _get32(const uint8_t* data)
+{
+    return (static_cast<uint32_t>(data[0]) << 24)
+        | (static_cast<uint32_t>(data[1]) << 16)
+        | (static_cast<uint32_t>(data[2]) << 8)
+        | static_cast<uint32_t>(data[3]);
+}
+
+static inline void _put16(uint8_t* data, uint16_t value)
+{
+    data[0] = static_cast<uint8_t>(value >> 8);
+    data[1] = static_cast<uint8_t>(value);
+}
+
+// RFC 2181: a ttl with the highest bit set is read as zero
+static inline uint32_t _get_ttl(const uint8_t* data)
+{
+    uint32_t ttl = _get32(data);
+    return (ttl & 0x80000000u) ? 0 : ttl;
+}
+
+size_t DnsCodec::encode_query(
+    uint8_t* buffer,
+    size_t capacity,
+    uint16_t id,
+    const char* name,
+    size_t name_length,
+    DnsType type,
+    uint16_t udp_payload_size
+) {
+    // a trailing dot (fully qualified name) changes nothing
+    if (name_length && name[name_length - 1] == '.')
+        name_length--;
+
+    if (!name_length || name_length > SOCKSPP_DNS_MAX_NAME_LENGTH)
+        return 0;
+
+    // header + labels (one length octet more than the dots) + root + type/class
+    size_t size = SOCKSPP_DNS_HEADER_SIZE + name_length + 2 + 4;
+
+    if (udp_payload_size)
+        size += SOCKSPP_DNS_OPT_SIZE;
+
+    if (size > capacity)
+        return 0;
+
+    _put16(buffer, id);
+    _put16(buffer + 2, 0x0100); // standard query, recursion desired
+    _put16(buffer + 4, 1);      // questions
+    _put16(buffer + 6, 0);
+    _put16(buffer + 8, 0);
+    _put16(buffer + 10, udp_payload_size ? 1 : 0); // additional records
+
+    uint8_t* out = buffer + SOCKSPP_DNS_HEADER_SIZE;
+    size_t start = 0;
+
+    while (start <= name_length)
+    {
+        const char* dot = static_cast<const char*>(
+            memchr(name + start, '.', name_length - start)
+        );
+        size_t end = dot ? dot - name : name_length;
+        size_t label_length = end - start;
+
+        if (!label_length || label_length > 63)
+            return 0;
+
+        *out++ = static_cast<uint8_t>(label_length);
+        memcpy(out, name + start, label_length);
+        out += label_length;
+        start = end + 1;
+    }
+
+    *out++ = 0;
+    _put16(out, static_cast<uint16_t>(type));
+    _put16(out + 2, SOCKSPP_DNS_CLASS_IN);
+    out += 4;
+
+    if (udp_payload_size)
+    {
+        // RFC 6891: root name, the payload size in place of the class,
+        // extended rcode, version 0 and no flags in place of the ttl
+        *out++ = 0;
+        _put16(out, static_cast<uint16_t>(DnsType::OPT));
+        _put16(out + 2, std::max<uint16_t>(udp_payload_size, SOCKSPP_DNS_MAX_UDP_SIZE));
+        memset(out + 4, 0, 6);
+    }
+
+    return size;
+}
+
+bool DnsCodec::decode_response(
+    const uint8_t* data,
+    size_t size,
+    DnsResponse& response
+) {
+    if (size < SOCKSPP_DNS_HEADER_SIZE)
+        return false;
+
+    uint16_t flags = _get16(data + 2);
+
+    // a response (QR) to a standard query (opcode 0) with one question
+    if (!(flags & 0x8000) || (flags & 0x7800) || _get16(data + 4) != 1)
+        return false;
+
+    response.id = _get16(data);
+    response.rcode = static_cast<DnsRCode>(flags & 0x000F);
+    response.truncated = flags & 0x0200;
+    response.address_count = 0;
+    response.answer_ttl = UINT32_MAX;
+    response.soa_ttl = UINT32_MAX;
+
+    uint16_t answer_count = _get16(data + 6);
+    uint16_t authority_count = _get16(data + 8);
+    size_t offset = SOCKSPP_DNS_HEADER_SIZE;
+
+    if (!_read_name(data, size, &offset, response.name, &response.name_length)
+        || offset + 4 > size)
+    {
+        return false;
+    }
+
+    response.type = static_cast<DnsType>(_get16(data + offset));
+    offset += 4;
+
+    for (uint32_t i = 0; i < answer_count + authority_count; i++)
+    {
+        if (!_skip_name(data, size, &offset) || offset + 10 > size)
+            return false;
+
+        uint16_t type = _get16(data + offset);
+        uint16_t cls = _get16(data + offset + 2);
+        uint32_t ttl = _get_ttl(data + offset + 4);
+        size_t rdata_length = _get16(data + offset + 8);
+        offset += 10;
+
+        if (offset + rdata_length > size)
+            return false;
+
+        const uint8_t* rdata = data + offset;
+        size_t rdata_offset = offset;
+        offset += rdata_length;
+
+        if (cls != SOCKSPP_DNS_CLASS_IN)
+            continue;
+
+        if (i < answer_count)
+        {
+            IPAddress::Version version;
+
+            if (type == static_cast<uint16_t>(DnsType::A) && rdata_length == 4)
+                version = IPAddress::Version::IPv4;
+            else if (type == static_cast<uint16_t>(DnsType::AAAA) && rdata_length == 16)
+                version = IPAddress::Version::IPv6;
+            else
+                continue; // CNAME chain and friends
+
+            response.answer_ttl = std::min(response.answer_ttl, ttl);
+
+            if (response.address_count < response.address_capacity)
+            {
+                response.addresses[response.address_count++] = IPAddress(
+                    version,
+                    const_cast<uint8_t*>(rdata),
+                    0
+                );
+            }
+        }
+        else if (type == static_cast<uint16_t>(DnsType::SOA))
+        {
+            // MNAME and RNAME, then serial, refresh, retry, expire, minimum
+            if (!_skip_name(data, size, &rdata_offset)
+                || !_skip_name(data, size, &rdata_offset)
+                || rdata_offset + 20 != offset)
+            {
+                return false;
+            }
+
+            uint32_t minimum = _get_ttl(data + rdata_offset + 16);
+            response.soa_ttl = std::min({ response.soa_ttl, ttl, minimum });
+        }
+    }
+
+    return true;
+}
+
+bool DnsCodec::_read_name(
+    const uint8_t* data,
+    size_t size,
+    size_t* offset,
+    char* name,
+    size_t* name_length
+) {
+    size_t pos = *offset;
+    size_t length = 0;
+    size_t wire_length = 0;
+    int pointers = 0;
+    bool jumped = false;
+
+    while (true)
+    {
+        if (pos >= size)
+            return false;
+
+        uint8_t label_length = data[pos];
+
+        if ((label_length & 0xC0) == 0xC0)
+        {
+            if (pos + 1 >= size || ++pointers > SOCKSPP_DNS_MAX_POINTERS)
+                return false;
+
+            size_t target = ((label_length & 0x3F) << 8) | data[pos + 1];
+
+            // only backwards, so a pointer can't point to itself
+            if (target >= pos)
+                return false;
+
+            if (!jumped)
+                *offset = pos + 2;
+
+            jumped = true;
+            pos = target;
+            continue;
+        }
+
+        if (label_length & 0xC0)
+            return false; // extended label types are not in use
+
+        wire_length += label_length + 1;
+
+        if (wire_length > SOCKSPP_DNS_MAX_WIRE_NAME_LENGTH
+            || pos + 1 + label_length > size)
+        {
+            return false;
+        }
+
+        if (!label_length)
+        {
+            if (!jumped)
+                *offset = pos + 1;
+
+            break;
+        }
+
+        if (length)
+            name[length++] = '.';
+
+        for (size_t i = 0; i < label_length; i++)
+        {
+            char c = static_cast<char>(data[pos + 1 + i]);
+            name[length++] = (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+        }
+
+        pos += 1 + label_length;
+    }
+
+    name[length] = '\0';
+    *name_length = length;
+    return true;
+}
+
+bool DnsCodec::_skip_name(const uint8_t* data, size_t size, size_t* offset)
+{
+    size_t pos = *offset;
+    size_t wire_length = 0;
+
+    while (pos < size)
+    {
+        uint8_t label_length = data[pos];
+
+        // the rest of the name is somewhere else, it was or will be
+        // checked when read, only the pointer itself is skipped here
+        if ((label_length & 0xC0) == 0xC0)
+        {
+            if (pos + 2 > size)
+                return false;
+
+            *offset = pos + 2;
+            return true;
+        }
+
+        if (label_length & 0xC0)
+            return false;
+
+        wire_length += label_length + 1;
+
+        if (wire_length > SOCKSPP_DNS_MAX_WIRE_NAME_LENGTH)
+            return false;
+
+        pos += 1 + label_length;
+
+        if (!label_length)
+        {
+            *offset = pos;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace sockspp
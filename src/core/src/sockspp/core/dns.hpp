@@ -0,0 +1,104 @@
+#pragma once
+
+#include "ip_address.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+// longest domain name in text form, without the trailing dot
+#define SOCKSPP_DNS_MAX_NAME_LENGTH 253
+
+// largest DNS message over UDP without EDNS
+#define SOCKSPP_DNS_MAX_UDP_SIZE 512
+
+// largest DNS message at all (TCP, 16 bit length prefix)
+#define SOCKSPP_DNS_MAX_MESSAGE_SIZE 65535
+
+// size of the OPT pseudo record added by EDNS0
+#define SOCKSPP_DNS_OPT_SIZE 11
+
+namespace sockspp
+{
+
+enum class DnsType : uint16_t
+{
+    A = 1,
+    NS = 2,
+    CNAME = 5,
+    SOA = 6,
+    AAAA = 28,
+    OPT = 41
+}; // enum class DnsType
+
+enum class DnsRCode : uint8_t
+{
+    NoError = 0,
+    FormatError = 1,
+    ServerFailure = 2,
+    NameError = 3,
+    NotImplemented = 4,
+    Refused = 5
+}; // enum class DnsRCode
+
+// Decoded response, addresses go to caller provided storage
+struct DnsResponse
+{
+    uint16_t id = 0;
+    DnsRCode rcode = DnsRCode::NoError;
+    bool truncated = false;
+    DnsType type = DnsType::A; // of the question
+
+    // question name in lower case, no trailing dot
+    char name[SOCKSPP_DNS_MAX_NAME_LENGTH + 1];
+    size_t name_length = 0;
+
+    // A / AAAA records of the answer section (port 0), the ones
+    // not fitting in the capacity are dropped
+    IPAddress* addresses = nullptr;
+    size_t address_capacity = 0;
+    size_t address_count = 0;
+
+    uint32_t answer_ttl = UINT32_MAX; // lowest ttl of the address records
+    uint32_t soa_ttl = UINT32_MAX;    // negative caching ttl (RFC 2308)
+}; // struct DnsResponse
+
+// DNS wire format (RFC 1035) of A / AAAA lookups without any heap
+// allocation: queries are written straight into the caller's buffer and
+// responses are read in place. Everything is bounds checked, compression
+// pointers have to point backwards and their number is limited.
+class DnsCodec
+{
+public:
+    // recursive query with a single question, with an EDNS0 OPT record
+    // advertising `udp_payload_size` unless it is 0 (no EDNS).
+    // 0 if the name is invalid or the buffer is too small
+    static size_t encode_query(
+        uint8_t* buffer,
+        size_t capacity,
+        uint16_t id,
+        const char* name,
+        size_t name_length,
+        DnsType type,
+        uint16_t udp_payload_size = 0
+    );
+
+    // false if the message is not a well formed response
+    static bool decode_response(
+        const uint8_t* data,
+        size_t size,
+        DnsResponse& response
+    );
+
+private:
+    static bool _read_name(
+        const uint8_t* data,
+        size_t size,
+        size_t* offset,
+        char* name,
+        size_t* name_length
+    );
+
+    static bool _skip_name(const uint8_t* data, size_t size, size_t* offset);
+}; // class DnsCodec
+
+} // namespace sockspp
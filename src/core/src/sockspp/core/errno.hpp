@@ -10,10 +10,26 @@
     #define SOCKSPP_EWOULDBLOCK WSAEWOULDBLOCK
     #define SOCKSPP_EAGAIN WSAEWOULDBLOCK
     #define SOCKSPP_EINPROGRESS WSAEINPROGRESS
+    #define SOCKSPP_ECONNREFUSED WSAECONNREFUSED
+    #define SOCKSPP_ENETUNREACH WSAENETUNREACH
+    #define SOCKSPP_EHOSTUNREACH WSAEHOSTUNREACH
+    #define SOCKSPP_ETIMEDOUT WSAETIMEDOUT
+    #define SOCKSPP_ECONNABORTED WSAECONNABORTED
+    #define SOCKSPP_EMFILE WSAEMFILE
+    #define SOCKSPP_ENFILE ENFILE
+    #define SOCKSPP_ENOBUFS WSAENOBUFS
 #else
     #define sockerrno errno
 
     #define SOCKSPP_EWOULDBLOCK EWOULDBLOCK
     #define SOCKSPP_EAGAIN EWOULDBLOCK
     #define SOCKSPP_EINPROGRESS EINPROGRESS
+    #define SOCKSPP_ECONNREFUSED ECONNREFUSED
+    #define SOCKSPP_ENETUNREACH ENETUNREACH
+    #define SOCKSPP_EHOSTUNREACH EHOSTUNREACH
+    #define SOCKSPP_ETIMEDOUT ETIMEDOUT
+    #define SOCKSPP_ECONNABORTED ECONNABORTED
+    #define SOCKSPP_EMFILE EMFILE
+    #define SOCKSPP_ENFILE ENFILE
+    #define SOCKSPP_ENOBUFS ENOBUFS
 #endif
@@ -14,6 +14,13 @@
 namespace sockspp
 {
 
+IPAddress::IPAddress()
+    : _port(0)
+    , _version(IPAddress::Version::IPv4)
+{
+    memset(_storage, 0, sizeof(_storage));
+}
+
 IPAddress::IPAddress(const std::string& ip, uint16_t port, bool netport)
 {
     if (inet_pton(AF_INET, ip.c_str(), this->get_address()))
@@ -83,4 +90,25 @@ uint16_t IPAddress::get_netport() const
     return htons(_port);
 }
 
+int IPAddress::to_sockaddr(void* sock_addr) const
+{
+    sockaddr_storage* addr = reinterpret_cast<sockaddr_storage*>(sock_addr);
+    memset(addr, 0, sizeof(sockaddr_storage));
+
+    if (_version == IPAddress::Version::IPv4)
+    {
+        sockaddr_in* s = reinterpret_cast<sockaddr_in*>(addr);
+        s->sin_family = AF_INET;
+        s->sin_port = get_netport();
+        memcpy(&s->sin_addr, _storage, 4);
+        return sizeof(sockaddr_in);
+    }
+
+    sockaddr_in6* s = reinterpret_cast<sockaddr_in6*>(addr);
+    s->sin6_family = AF_INET6;
+    s->sin6_port = get_netport();
+    memcpy(&s->sin6_addr, _storage, 16);
+    return sizeof(sockaddr_in6);
+}
+
 } // namespace sockspp
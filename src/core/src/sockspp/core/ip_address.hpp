@@ -17,6 +17,7 @@ public:
     };
 
 public:
+    IPAddress(); // 0.0.0.0:0
     IPAddress(const std::string& ip, uint16_t port, bool netport = false);
     IPAddress(Version version, uint8_t* ip, uint16_t port, bool netport = false);
 
@@ -25,6 +26,9 @@ public:
     uint16_t get_port() const;
     uint16_t get_netport() const;  // network byte order
 
+    // fills a sockaddr_storage, returns the length of the sockaddr
+    int to_sockaddr(void* sock_addr) const;
+
 private:
     uint8_t _storage[16];
     uint16_t _port;
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "exceptions.hpp"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace sockspp
+{
+
+// Slab allocator for objects of a single type. Memory is taken from
+// the system in slabs and never given back until the pool dies, freed
+// slots go to a LIFO free list so the most recently released (still
+// cache-warm) memory is handed out first. Not thread-safe.
+template <typename T>
+class ObjectPool
+{
+public:
+    ObjectPool(size_t slab_size = 64)
+        : _free(nullptr)
+        , _slab_size(slab_size ? slab_size : 1)
+        , _capacity(0)
+        , _size(0) {}
+
+    ObjectPool(const ObjectPool& other) = delete;
+
+    // objects still alive at this point are not destructed
+    ~ObjectPool()
+    {
+        for (Slot* slab : _slabs)
+        {
+            free(slab);
+        }
+    }
+
+    void reserve(size_t count)
+    {
+        if (count > _capacity)
+        {
+            this->_grow(count - _capacity);
+        }
+    }
+
+    template <typename... Args>
+    T* create(Args&&... args)
+    {
+        if (!_free)
+        {
+            this->_grow(_slab_size);
+        }
+
+        Slot* slot = _free;
+        _free = slot->next;
+
+        T* object;
+
+        try {
+            object = new (slot->storage) T(std::forward<Args>(args)...);
+        } catch (...) {
+            slot->next = _free;
+            _free = slot;
+            throw;
+        }
+
+        _size++;
+        return object;
+    }
+
+    void destroy(T* object)
+    {
+        if (!object)
+            return;
+
+        object->~T();
+
+        Slot* slot = reinterpret_cast<Slot*>(object);
+        slot->next = _free;
+        _free = slot;
+        _size--;
+    }
+
+    size_t get_size() const
+    {
+        return _size;
+    }
+
+    size_t get_capacity() const
+    {
+        return _capacity;
+    }
+
+private:
+    union Slot
+    {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    }; // union Slot
+
+    void _grow(size_t count)
+    {
+        Slot* slab = reinterpret_cast<Slot*>(malloc(sizeof(Slot) * count));
+
+        if (!slab)
+        {
+            throw MemoryAllocationException(sizeof(Slot) * count);
+        }
+
+        _slabs.push_back(slab);
+
+        // pushed backwards, so slots are handed out in address order
+        for (size_t i = count; i-- > 0;)
+        {
+            slab[i].next = _free;
+            _free = &slab[i];
+        }
+
+        _capacity += count;
+    }
+
+private:
+    std::vector<Slot*> _slabs;
+    Slot* _free;
+    size_t _slab_size;
+    size_t _capacity;
+    size_t _size;
+
+}; // class ObjectPool
+
+} // namespace sockspp
@@ -0,0 +1,112 @@
+#include "pipe.hpp"
+
+#include <cerrno>
+
+#if defined(__linux__)
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif // __linux__
+
+namespace sockspp
+{
+
+Pipe::Pipe()
+    : _fds{-1, -1}
+    , _size(0) {}
+
+Pipe::~Pipe()
+{
+    this->close();
+}
+
+bool Pipe::open(size_t capacity)
+{
+#if defined(__linux__)
+    if (this->is_open())
+        return true;
+
+    if (pipe2(_fds, O_NONBLOCK | O_CLOEXEC) == -1)
+    {
+        _fds[0] = _fds[1] = -1;
+        return false;
+    }
+
+    // not fatal, the default capacity is used then
+    if (capacity)
+        fcntl(_fds[1], F_SETPIPE_SZ, static_cast<int>(capacity));
+
+    _size = 0;
+    return true;
+#else
+    errno = ENOSYS;
+    return false;
+#endif // __linux__
+}
+
+void Pipe::close()
+{
+#if defined(__linux__)
+    for (int& fd : _fds)
+    {
+        if (fd != -1)
+        {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+#endif // __linux__
+
+    _size = 0;
+}
+
+bool Pipe::is_open() const
+{
+    return _fds[0] != -1;
+}
+
+int Pipe::splice_from(int fd, size_t size)
+{
+#if defined(__linux__)
+    ssize_t res = splice(
+        fd, nullptr,
+        _fds[1], nullptr,
+        size,
+        SPLICE_F_MOVE | SPLICE_F_NONBLOCK
+    );
+
+    if (res > 0)
+        _size += res;
+
+    return static_cast<int>(res);
+#else
+    errno = ENOSYS;
+    return -1;
+#endif // __linux__
+}
+
+int Pipe::splice_to(int fd, size_t size)
+{
+#if defined(__linux__)
+    ssize_t res = splice(
+        _fds[0], nullptr,
+        fd, nullptr,
+        size,
+        SPLICE_F_MOVE | SPLICE_F_NONBLOCK
+    );
+
+    if (res > 0)
+        _size -= res;
+
+    return static_cast<int>(res);
+#else
+    errno = ENOSYS;
+    return -1;
+#endif // __linux__
+}
+
+size_t Pipe::get_size() const
+{
+    return _size;
+}
+
+} // namespace sockspp
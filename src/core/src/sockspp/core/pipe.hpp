@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+namespace sockspp
+{
+
+// Kernel pipe used as an in-kernel buffer for splice(), data moved
+// through it never reaches user space (Linux only, open() fails elsewhere)
+class Pipe
+{
+public:
+    Pipe();
+    Pipe(const Pipe& other) = delete;
+    ~Pipe();
+
+    bool open(size_t capacity = 0);
+    void close();
+    bool is_open() const;
+
+    // socket -> pipe
+    int splice_from(int fd, size_t size);
+    // pipe -> socket
+    int splice_to(int fd, size_t size);
+
+    // number of bytes currently held by the pipe
+    size_t get_size() const;
+
+private:
+    int _fds[2];
+    size_t _size;
+
+}; // class Pipe
+
+} // namespace sockspp
@@ -97,6 +97,12 @@ public:
         );
     }
 
+    // readiness only, see UringPoller
+    bool has_completions() const
+    {
+        return false;
+    }
+
     int poll(std::vector<Event>& out_events, int timeout)
     {
         epoll_event events[_poll_batch];
@@ -11,6 +11,14 @@
 #define SOCKSPP_POLLHUP EPOLLHUP
 #define SOCKSPP_POLLERR EPOLLERR
 
+#if defined(EPOLLET)
+    #define SOCKSPP_POLLET EPOLLET
+#else
+    #define SOCKSPP_POLLET 0
+#endif
+
+#include <cstdint>
+
 namespace sockspp
 {
 
@@ -22,7 +30,14 @@ public:
         Read = SOCKSPP_POLLIN,
         Write = SOCKSPP_POLLOUT,
         Closed = SOCKSPP_POLLHUP,
-        Error = SOCKSPP_POLLERR
+        Error = SOCKSPP_POLLERR,
+        Edge = SOCKSPP_POLLET, // reported once per change, sockets are drained
+
+        // completions of pollers which do the I/O themselves
+        // (see SOCKSPP_POLLER_COMPLETIONS), result tells how it went
+        Accepted = 1u << 24, // result is the new descriptor
+        Received = 1u << 25, // result bytes of data, 0 at EOF
+        Sent = 1u << 26 // result bytes
     }; // enum class Flags
 
 public:
@@ -31,6 +46,13 @@ public:
     , _flags(flags)
     , _ptr(ptr) {}
 
+    Event(int fd, Flags flags, void* ptr, int result, const uint8_t* data = nullptr)
+    : _fd(fd)
+    , _flags(flags)
+    , _ptr(ptr)
+    , _result(result)
+    , _data(data) {}
+
     inline int get_fd() const
     {
         return _fd;
@@ -46,10 +68,23 @@ public:
         return _ptr;
     }
 
+    // errno negated on failure
+    inline int get_result() const
+    {
+        return _result;
+    }
+
+    inline const uint8_t* get_data() const
+    {
+        return _data;
+    }
+
 private:
     void* _ptr;
     Flags _flags;
     int _fd;
+    int _result = 0;
+    const uint8_t* _data = nullptr;
 }; // class Event
 
 } // namespace sockspp
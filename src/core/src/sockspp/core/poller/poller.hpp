@@ -1,8 +1,20 @@
 #pragma once
 
-#if defined(_WIN32) || defined(__linux__)
+#if SOCKSPP_IO_URING && defined(__linux__)
+    #include "uring_poller.hpp"
+
+    // Event::Accepted/Received/Sent may be used if has_completions()
+    #define SOCKSPP_POLLER_COMPLETIONS 1
+
+    namespace sockspp
+    {
+        using Poller = sockspp::UringPoller;
+    }
+#elif defined(_WIN32) || defined(__linux__)
     #include "epoll_poller.hpp"
 
+    #define SOCKSPP_POLLER_COMPLETIONS 0
+
     namespace sockspp
     {
         using Poller = sockspp::EpollPoller;
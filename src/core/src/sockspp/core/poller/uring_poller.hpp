@@ -0,0 +1,830 @@
+#pragma once
+
+#include "event.hpp"
+#include "../exceptions.hpp"
+
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+// size of the submission queue (completion queue is twice as big)
+#define URING_ENTRIES 1024
+
+#ifndef POLL_BATCH
+    #define POLL_BATCH 512
+#endif
+
+// user_data of requests which completions are not interesting for us
+#define URING_IGNORE_DATA UINT64_MAX
+
+// user_data bit of sends, the rest is the pointer they were queued with
+#define URING_SEND_DATA (1ull << 63)
+
+// provided buffers multishot receives complete into (count: power of two)
+#define URING_BUFFER_COUNT 256
+#define URING_BUFFER_SIZE 16384
+#define URING_BUFFER_GROUP 0
+
+namespace sockspp
+{
+
+// io_uring backend with the same readiness interface as EpollPoller.
+//
+// A registration is an IORING_OP_POLL_ADD: oneshot and re-armed after
+// it fires, which keeps epoll's level triggered semantics so sessions
+// don't need to drain sockets, or multishot (IORING_POLL_ADD_MULTI) for
+// the Event::Edge ones, which stays armed like EPOLLET.
+//
+// On kernels with completion requests (6.0+, see has_completions())
+// a registration may instead be:
+//  - Event::Accepted: a multishot accept, each connection is reported
+//    with its descriptor, already non-blocking
+//  - Event::Received: a multishot recv completing into a ring of
+//    buffers provided by the poller, each chunk is reported with its
+//    data (0 bytes at EOF)
+// and send() queues IORING_OP_SEND requests, reported as Event::Sent.
+//
+// Every request is only queued as an SQE and then submitted together
+// with the wait in a single io_uring_enter() per loop iteration, instead
+// of one syscall each.
+//
+// user_data of a registration request is (fd << 32 | generation),
+// generation is bumped on every modification/removal so completions of
+// stale requests are dropped without looking at the pointer they were
+// registered with. Sends carry their pointer instead, their completion
+// is always reported so the owner knows when the data is released.
+class UringPoller
+{
+public:
+    UringPoller()
+    : _fd(-1)
+    , _poll_batch(POLL_BATCH)
+    , _buffer_lent(URING_BUFFER_COUNT, false)
+    , _buffer_held(URING_BUFFER_COUNT, false)
+    {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+
+        _fd = syscall(__NR_io_uring_setup, URING_ENTRIES, &params);
+
+        if (_fd < 0)
+        {
+            _fd = -1;
+            throw PollerCreationException("io_uring_setup");
+        }
+
+        if (!(params.features & IORING_FEAT_EXT_ARG)
+            || !(params.features & IORING_FEAT_NODROP))
+        {
+            this->_release();
+            errno = ENOSYS;
+            throw PollerCreationException("io_uring features");
+        }
+
+        if (!this->_map_rings(params))
+        {
+            int error = errno;
+            this->_release();
+            errno = error;
+            throw PollerCreationException("io_uring mmap");
+        }
+
+        // readiness polls only if the kernel is older or out of memory
+        if (this->_has_completion_ops())
+        {
+            this->_map_buffers();
+        }
+    }
+
+    UringPoller(const UringPoller& other) = delete;
+
+    ~UringPoller()
+    {
+        this->_release();
+    }
+
+    bool register_event(const Event& event)
+    {
+        return this->set_event(event.get_fd(), event.get_ptr(), event.get_flags());
+    }
+
+    bool update_event(const Event& event)
+    {
+        return this->set_event(event.get_fd(), event.get_ptr(), event.get_flags(), true);
+    }
+
+    bool remove_event(const Event& event)
+    {
+        return this->remove_event(event.get_fd());
+    }
+
+    // shortcuts
+    bool remove_event(int fd)
+    {
+        if (fd < 0 || static_cast<size_t>(fd) >= _registrations.size())
+        {
+            return false;
+        }
+
+        Registration& reg = _registrations[fd];
+
+        if (!reg.active)
+        {
+            return false;
+        }
+
+        if (reg.armed)
+        {
+            this->_queue_cancel(fd, reg);
+        }
+
+        // the descriptor is usually closed next, queued sends
+        // have to reach the kernel while it's still the same file
+        if (_sends_queued)
+        {
+            this->_enter(0, 0);
+        }
+
+        reg.active = false;
+        reg.armed = false;
+        reg.generation++;
+
+        return true;
+    }
+
+    inline bool set_event(int fd, void* ptr, Event::Flags flags, bool is_mod = false)
+    {
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        if ((flags & (Event::Accepted | Event::Received)) && !this->has_completions())
+        {
+            errno = EOPNOTSUPP;
+            return false;
+        }
+
+        if (static_cast<size_t>(fd) >= _registrations.size())
+        {
+            _registrations.resize(fd + 1);
+        }
+
+        Registration& reg = _registrations[fd];
+
+        // keep epoll_ctl semantics, ADD on a registered fd and
+        // MOD on an unregistered one are errors
+        if (reg.active != is_mod)
+        {
+            errno = is_mod ? ENOENT : EEXIST;
+            return false;
+        }
+
+        if (reg.active && reg.ptr == ptr && reg.flags == flags)
+        {
+            return true;
+        }
+
+        if (reg.armed)
+        {
+            this->_queue_cancel(fd, reg);
+            reg.armed = false;
+        }
+
+        reg.generation++;
+        reg.ptr = ptr;
+        reg.flags = flags;
+        reg.active = true;
+
+        if (!is_mod)
+        {
+            reg.added = reg.generation;
+        }
+        this->_queue_arm(fd);
+
+        return true;
+    }
+
+    // whether Event::Accepted/Received registrations and send() are
+    // available
+    bool has_completions() const
+    {
+        return _buffers != nullptr;
+    }
+
+    // queues a send of data, which must stay untouched until the
+    // Event::Sent carrying ptr reports how much of it went out
+    bool send(int fd, void* ptr, const void* data, size_t size)
+    {
+        io_uring_sqe* sqe = this->_get_sqe();
+
+        if (!sqe)
+        {
+            return false;
+        }
+
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(data);
+        sqe->len = static_cast<uint32_t>(std::min<size_t>(size, UINT32_MAX));
+        sqe->msg_flags = MSG_NOSIGNAL;
+        sqe->user_data = URING_SEND_DATA | reinterpret_cast<uint64_t>(ptr);
+        _sends_queued = true;
+
+        return true;
+    }
+
+    // data of an Event::Received is given back to the kernel on the
+    // next poll(), unless it's held until release_buffer()
+    void hold_buffer(const uint8_t* data)
+    {
+        _buffer_held[this->_get_buffer_id(data)] = true;
+    }
+
+    void release_buffer(const uint8_t* data)
+    {
+        uint16_t bid = this->_get_buffer_id(data);
+
+        if (!_buffer_held[bid])
+        {
+            return;
+        }
+
+        _buffer_held[bid] = false;
+
+        // still lent by the last poll(), it's given back with the others
+        if (!_buffer_lent[bid])
+        {
+            this->_recycle_buffer(bid);
+        }
+    }
+
+    int poll(std::vector<Event>& out_events, int timeout)
+    {
+        this->_recycle_lent_buffers();
+
+        if (_buffer_returned)
+        {
+            for (int fd : _starved)
+            {
+                this->_queue_arm(fd);
+            }
+
+            _starved.clear();
+            _buffer_returned = false;
+        }
+
+        this->_arm_pending();
+
+        bool ready = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE) != *_cq_head;
+        int res = this->_enter((ready || !timeout) ? 0 : 1, timeout);
+
+        if (res < 0 && errno != ETIME && errno != EBUSY)
+        {
+            return -1;
+        }
+
+        return this->_reap(out_events);
+    }
+
+private:
+    struct Registration
+    {
+        void* ptr = nullptr;
+        uint32_t flags = 0;
+        uint32_t generation = 0;
+        uint32_t added = 0; // generation the fd was registered with
+        bool active = false;
+        bool armed = false;
+        bool queued = false;
+    }; // struct Registration
+
+    bool _has_completion_ops()
+    {
+        // IORING_OP_SEND_ZC came with multishot recv (6.0), provided
+        // buffer rings and multishot accept are a bit older
+        std::vector<uint8_t> mem(
+            sizeof(io_uring_probe) + IORING_OP_LAST * sizeof(io_uring_probe_op)
+        );
+        io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(mem.data());
+
+        if (syscall(__NR_io_uring_register, _fd, IORING_REGISTER_PROBE, probe, IORING_OP_LAST) < 0)
+        {
+            return false;
+        }
+
+        return probe->last_op >= IORING_OP_SEND_ZC
+            && (probe->ops[IORING_OP_SEND_ZC].flags & IO_URING_OP_SUPPORTED);
+    }
+
+    bool _map_buffers()
+    {
+        _buffer_ring_size = URING_BUFFER_COUNT * sizeof(io_uring_buf);
+
+        void* ring = mmap(
+            nullptr, _buffer_ring_size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+        );
+
+        if (ring == MAP_FAILED)
+        {
+            return false;
+        }
+
+        void* buffers = mmap(
+            nullptr, URING_BUFFER_COUNT * URING_BUFFER_SIZE, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+        );
+
+        if (buffers == MAP_FAILED)
+        {
+            munmap(ring, _buffer_ring_size);
+            return false;
+        }
+
+        io_uring_buf_reg reg;
+        memset(&reg, 0, sizeof(reg));
+        reg.ring_addr = reinterpret_cast<uint64_t>(ring);
+        reg.ring_entries = URING_BUFFER_COUNT;
+        reg.bgid = URING_BUFFER_GROUP;
+
+        if (syscall(__NR_io_uring_register, _fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+        {
+            munmap(buffers, URING_BUFFER_COUNT * URING_BUFFER_SIZE);
+            munmap(ring, _buffer_ring_size);
+            return false;
+        }
+
+        _buffer_ring = reinterpret_cast<io_uring_buf_ring*>(ring);
+        _buffers = reinterpret_cast<uint8_t*>(buffers);
+
+        for (uint16_t bid = 0; bid < URING_BUFFER_COUNT; bid++)
+        {
+            this->_recycle_buffer(bid);
+        }
+
+        return true;
+    }
+
+    uint16_t _get_buffer_id(const uint8_t* data) const
+    {
+        return static_cast<uint16_t>((data - _buffers) / URING_BUFFER_SIZE);
+    }
+
+    void _recycle_buffer(uint16_t bid)
+    {
+        // the tail shares its memory with the first entry, only
+        // the fields the kernel reads are written. Entries are not
+        // reached through bufs, its flexible array declaration puts
+        // it 8 bytes off in C++.
+        io_uring_buf* buf = reinterpret_cast<io_uring_buf*>(_buffer_ring)
+            + (_buffer_tail & (URING_BUFFER_COUNT - 1));
+        buf->addr = reinterpret_cast<uint64_t>(_buffers + bid * URING_BUFFER_SIZE);
+        buf->len = URING_BUFFER_SIZE;
+        buf->bid = bid;
+
+        _buffer_returned = true;
+        _buffer_tail++;
+        __atomic_store_n(&_buffer_ring->tail, _buffer_tail, __ATOMIC_RELEASE);
+    }
+
+    void _recycle_lent_buffers()
+    {
+        for (uint16_t bid : _lent)
+        {
+            _buffer_lent[bid] = false;
+
+            if (!_buffer_held[bid])
+            {
+                this->_recycle_buffer(bid);
+            }
+        }
+
+        _lent.clear();
+    }
+
+    bool _map_rings(const io_uring_params& params)
+    {
+        _sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        _cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        _sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+
+        bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+
+        if (single_mmap)
+        {
+            _sq_ring_size = _cq_ring_size = std::max(_sq_ring_size, _cq_ring_size);
+        }
+
+        _sq_ring = mmap(
+            nullptr, _sq_ring_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQ_RING
+        );
+
+        if (_sq_ring == MAP_FAILED)
+        {
+            _sq_ring = nullptr;
+            return false;
+        }
+
+        if (single_mmap)
+        {
+            _cq_ring = _sq_ring;
+        }
+        else
+        {
+            _cq_ring = mmap(
+                nullptr, _cq_ring_size, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_CQ_RING
+            );
+
+            if (_cq_ring == MAP_FAILED)
+            {
+                _cq_ring = nullptr;
+                return false;
+            }
+        }
+
+        void* sqes = mmap(
+            nullptr, _sqes_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQES
+        );
+
+        if (sqes == MAP_FAILED)
+        {
+            return false;
+        }
+
+        _sqes = reinterpret_cast<io_uring_sqe*>(sqes);
+
+        uint8_t* sq = reinterpret_cast<uint8_t*>(_sq_ring);
+        _sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        _sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        _sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        _sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        _sq_entries = params.sq_entries;
+        _sq_local_tail = *_sq_tail;
+
+        uint8_t* cq = reinterpret_cast<uint8_t*>(_cq_ring);
+        _cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        _cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        _cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        _cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        return true;
+    }
+
+    void _release()
+    {
+        if (_sqes)
+        {
+            munmap(_sqes, _sqes_size);
+            _sqes = nullptr;
+        }
+
+        if (_cq_ring && _cq_ring != _sq_ring)
+        {
+            munmap(_cq_ring, _cq_ring_size);
+        }
+
+        if (_sq_ring)
+        {
+            munmap(_sq_ring, _sq_ring_size);
+        }
+
+        _sq_ring = nullptr;
+        _cq_ring = nullptr;
+
+        if (_fd != -1)
+        {
+            close(_fd);
+            _fd = -1;
+        }
+
+        if (_buffers)
+        {
+            munmap(_buffers, URING_BUFFER_COUNT * URING_BUFFER_SIZE);
+            munmap(_buffer_ring, _buffer_ring_size);
+            _buffers = nullptr;
+            _buffer_ring = nullptr;
+        }
+    }
+
+    io_uring_sqe* _get_sqe()
+    {
+        unsigned head = __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+
+        while (_sq_local_tail - head >= _sq_entries)
+        {
+            // queue is full, flush it without waiting
+            if (this->_enter(0, 0) < 0 && errno != EINTR && errno != EBUSY)
+            {
+                return nullptr;
+            }
+
+            head = __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+        }
+
+        unsigned idx = _sq_local_tail & _sq_mask;
+        io_uring_sqe* sqe = &_sqes[idx];
+        memset(sqe, 0, sizeof(*sqe));
+        _sq_array[idx] = idx;
+        _sq_local_tail++;
+
+        return sqe;
+    }
+
+    int _enter(unsigned min_complete, int timeout)
+    {
+        __atomic_store_n(_sq_tail, _sq_local_tail, __ATOMIC_RELEASE);
+        _sends_queued = false;
+        unsigned to_submit = _sq_local_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+
+        if (!min_complete)
+        {
+            if (!to_submit)
+            {
+                return 0;
+            }
+
+            return syscall(__NR_io_uring_enter, _fd, to_submit, 0, 0, nullptr, 0);
+        }
+
+        io_uring_getevents_arg arg;
+        __kernel_timespec ts;
+        memset(&arg, 0, sizeof(arg));
+
+        if (timeout >= 0)
+        {
+            ts.tv_sec = timeout / 1000;
+            ts.tv_nsec = (timeout % 1000) * 1000000;
+            arg.ts = reinterpret_cast<uint64_t>(&ts);
+        }
+
+        return syscall(
+            __NR_io_uring_enter,
+            _fd,
+            to_submit,
+            min_complete,
+            IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+            &arg,
+            sizeof(arg)
+        );
+    }
+
+    int _reap(std::vector<Event>& out_events)
+    {
+        unsigned head = *_cq_head;
+        unsigned tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+        int count = 0;
+
+        for (; head != tail && count < _poll_batch; head++)
+        {
+            io_uring_cqe* cqe = &_cqes[head & _cq_mask];
+            uint64_t data = cqe->user_data;
+
+            if (data == URING_IGNORE_DATA)
+            {
+                continue;
+            }
+
+            if (data & URING_SEND_DATA)
+            {
+                out_events.emplace_back(
+                    -1,
+                    Event::Sent,
+                    reinterpret_cast<void*>(data & ~URING_SEND_DATA),
+                    cqe->res
+                );
+
+                count++;
+                continue;
+            }
+
+            int fd = static_cast<int>(data >> 32);
+            uint32_t generation = static_cast<uint32_t>(data);
+            bool more = cqe->flags & IORING_CQE_F_MORE;
+            uint8_t* buffer = nullptr;
+
+            if (cqe->flags & IORING_CQE_F_BUFFER)
+            {
+                uint16_t bid = static_cast<uint16_t>(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+                buffer = _buffers + bid * URING_BUFFER_SIZE;
+                _buffer_lent[bid] = true;
+                _lent.push_back(bid);
+            }
+
+            if (static_cast<size_t>(fd) >= _registrations.size())
+            {
+                continue;
+            }
+
+            Registration& reg = _registrations[fd];
+
+            if (!reg.active || reg.generation != generation || !reg.armed)
+            {
+                // data received before a modification (e.g. a pause)
+                // is still the socket's, only a removal drops it
+                if (buffer && cqe->res > 0 && reg.active
+                    && generation - reg.added < reg.generation - reg.added)
+                {
+                    out_events.emplace_back(fd, Event::Received, reg.ptr, cqe->res, buffer);
+                    count++;
+                }
+
+                // accepted before the cancellation reached the kernel,
+                // nobody takes the connection anymore
+                if ((reg.flags & Event::Accepted) && cqe->res >= 0)
+                {
+                    ::close(cqe->res);
+                }
+
+                // completion of a modified or removed registration
+                continue;
+            }
+
+            if (!more)
+            {
+                reg.armed = false;
+            }
+
+            if (cqe->res == -ENOBUFS)
+            {
+                // every provided buffer is lent out, receive again
+                // once one of them is given back
+                _starved.push_back(fd);
+                continue;
+            }
+
+            if (cqe->res == -ECANCELED)
+            {
+                this->_queue_arm(fd);
+                continue;
+            }
+
+            Event::Flags flags = static_cast<Event::Flags>(cqe->res);
+
+            if (reg.flags & Event::Accepted)
+            {
+                // the listener is gone (shutdown) or broken
+                if (cqe->res == -EINVAL || cqe->res == -EBADF)
+                {
+                    out_events.emplace_back(fd, Event::Error, reg.ptr, cqe->res);
+                    count++;
+                    continue;
+                }
+
+                flags = Event::Accepted;
+            }
+            else if (reg.flags & Event::Received)
+            {
+                flags = cqe->res < 0 ? Event::Error : Event::Received;
+            }
+            else if (cqe->res < 0)
+            {
+                // the poll request itself failed (e.g. bad fd), it is
+                // reported as an error and not re-armed
+                flags = Event::Error;
+            }
+
+            // EOF ends a receive and errors end anything but accepts
+            bool rearm = cqe->res > 0
+                || (cqe->res == 0 && !(reg.flags & Event::Received))
+                || (reg.flags & Event::Accepted);
+
+            if (!more && rearm)
+            {
+                this->_queue_arm(fd);
+            }
+
+            out_events.emplace_back(fd, flags, reg.ptr, cqe->res, buffer);
+            count++;
+        }
+
+        __atomic_store_n(_cq_head, head, __ATOMIC_RELEASE);
+
+        return count;
+    }
+
+    void _queue_arm(int fd)
+    {
+        Registration& reg = _registrations[fd];
+
+        if (!reg.queued)
+        {
+            reg.queued = true;
+            _pending.push_back(fd);
+        }
+    }
+
+    void _arm_pending()
+    {
+        for (int fd : _pending)
+        {
+            Registration& reg = _registrations[fd];
+            reg.queued = false;
+
+            if (!reg.active || reg.armed)
+            {
+                continue;
+            }
+
+            io_uring_sqe* sqe = this->_get_sqe();
+
+            if (!sqe)
+            {
+                continue;
+            }
+
+            sqe->fd = fd;
+            sqe->user_data = (static_cast<uint64_t>(fd) << 32) | reg.generation;
+
+            if (reg.flags & Event::Accepted)
+            {
+                sqe->opcode = IORING_OP_ACCEPT;
+                sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+                sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+            }
+            else if (reg.flags & Event::Received)
+            {
+                sqe->opcode = IORING_OP_RECV;
+                sqe->ioprio = IORING_RECV_MULTISHOT;
+                sqe->flags = IOSQE_BUFFER_SELECT;
+                sqe->buf_group = URING_BUFFER_GROUP;
+            }
+            else
+            {
+                sqe->opcode = IORING_OP_POLL_ADD;
+                sqe->poll32_events = reg.flags;
+                sqe->len = (reg.flags & Event::Edge) ? IORING_POLL_ADD_MULTI : 0;
+            }
+
+            reg.armed = true;
+        }
+
+        _pending.clear();
+    }
+
+    void _queue_cancel(int fd, const Registration& reg)
+    {
+        io_uring_sqe* sqe = this->_get_sqe();
+
+        if (!sqe)
+        {
+            return;
+        }
+
+        bool is_poll = !(reg.flags & (Event::Accepted | Event::Received));
+
+        sqe->opcode = is_poll ? IORING_OP_POLL_REMOVE : IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = (static_cast<uint64_t>(fd) << 32) | reg.generation;
+        sqe->user_data = URING_IGNORE_DATA;
+    }
+
+private:
+    int _fd;
+    int _poll_batch;
+
+    void* _sq_ring = nullptr;
+    void* _cq_ring = nullptr;
+    io_uring_sqe* _sqes = nullptr;
+    size_t _sq_ring_size = 0;
+    size_t _cq_ring_size = 0;
+    size_t _sqes_size = 0;
+
+    unsigned* _sq_head = nullptr;
+    unsigned* _sq_tail = nullptr;
+    unsigned* _sq_array = nullptr;
+    unsigned _sq_mask = 0;
+    unsigned _sq_entries = 0;
+    unsigned _sq_local_tail = 0;
+
+    unsigned* _cq_head = nullptr;
+    unsigned* _cq_tail = nullptr;
+    unsigned _cq_mask = 0;
+    io_uring_cqe* _cqes = nullptr;
+
+    std::vector<Registration> _registrations;
+    std::vector<int> _pending;
+    std::vector<int> _starved; // receives waiting for a buffer
+    bool _sends_queued = false;
+
+    io_uring_buf_ring* _buffer_ring = nullptr;
+    size_t _buffer_ring_size = 0;
+    uint8_t* _buffers = nullptr;  // URING_BUFFER_COUNT * URING_BUFFER_SIZE
+    uint16_t _buffer_tail = 0;
+    std::vector<uint16_t> _lent;  // reported by the last poll()
+    std::vector<bool> _buffer_lent;
+    std::vector<bool> _buffer_held;
+    bool _buffer_returned = false;
+}; // class UringPoller
+
+} // namespace sockspp
@@ -0,0 +1,150 @@
+#include "ring_buffer.hpp"
+#include "exceptions.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace sockspp
+{
+
+RingBuffer::RingBuffer()
+    : _ptr(nullptr)
+    , _capacity(0)
+    , _head(0)
+    , _size(0) {}
+
+RingBuffer::RingBuffer(size_t capacity)
+    : RingBuffer()
+{
+    _capacity = capacity;
+}
+
+RingBuffer::~RingBuffer()
+{
+    this->_release();
+}
+
+void RingBuffer::set_capacity(size_t capacity)
+{
+    if (_size)
+        return;
+
+    if (capacity != _capacity)
+        this->_release();
+
+    _capacity = capacity;
+    _head = 0;
+}
+
+size_t RingBuffer::get_capacity() const
+{
+    return _capacity;
+}
+
+size_t RingBuffer::get_size() const
+{
+    return _size;
+}
+
+size_t RingBuffer::get_free() const
+{
+    return _capacity - _size;
+}
+
+bool RingBuffer::is_empty() const
+{
+    return _size == 0;
+}
+
+size_t RingBuffer::write(const void* ptr, size_t size)
+{
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(ptr);
+    size_t written = 0;
+
+    while (written < size)
+    {
+        MemoryBuffer region = this->get_write_buffer();
+
+        if (!region.get_capacity())
+            break;
+
+        size_t copy_size = region.get_capacity() < size - written
+            ? region.get_capacity()
+            : size - written;
+
+        memcpy(region.get_ptr(), data + written, copy_size);
+        this->commit(copy_size);
+        written += copy_size;
+    }
+
+    return written;
+}
+
+MemoryBuffer RingBuffer::get_write_buffer()
+{
+    if (_size == _capacity)
+        return MemoryBuffer();
+
+    this->_allocate();
+
+    size_t tail = (_head + _size) % _capacity;
+    size_t contiguous = tail >= _head
+        ? _capacity - tail
+        : _head - tail;
+
+    return MemoryBuffer(_ptr + tail, 0, contiguous);
+}
+
+void RingBuffer::commit(size_t size)
+{
+    _size += size;
+}
+
+MemoryBuffer RingBuffer::get_read_buffer() const
+{
+    if (!_size)
+        return MemoryBuffer();
+
+    size_t contiguous = _head + _size > _capacity
+        ? _capacity - _head
+        : _size;
+
+    return MemoryBuffer(_ptr + _head, contiguous, contiguous);
+}
+
+void RingBuffer::consume(size_t size)
+{
+    _size -= size;
+    _head = _size ? (_head + size) % _capacity : 0;
+}
+
+void RingBuffer::clear()
+{
+    _head = 0;
+    _size = 0;
+    this->_release();
+}
+
+void RingBuffer::_allocate()
+{
+    if (_ptr)
+        return;
+
+    _ptr = reinterpret_cast<uint8_t*>(malloc(_capacity));
+
+    if (!_ptr)
+    {
+        throw MemoryAllocationException(_capacity);
+    }
+}
+
+void RingBuffer::_release()
+{
+    if (!_ptr)
+        return;
+
+    free(_ptr);
+    _ptr = nullptr;
+}
+
+} // namespace sockspp
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "memory_buffer.hpp"
+
+#include <cstddef>
+
+namespace sockspp
+{
+
+// Fixed capacity FIFO byte buffer (in heap). Memory is allocated
+// lazily on the first write and kept until clear() or destruction,
+// reads and writes are exposed as contiguous MemoryBuffer regions so
+// sockets can use them directly.
+class RingBuffer
+{
+public:
+    RingBuffer();
+    RingBuffer(size_t capacity);
+    RingBuffer(const RingBuffer& other) = delete;
+    ~RingBuffer();
+
+    void set_capacity(size_t capacity); // only while empty
+    size_t get_capacity() const;
+    size_t get_size() const;
+    size_t get_free() const;
+    bool is_empty() const;
+
+    // appends as much as fits, returns the number of bytes written
+    size_t write(const void* ptr, size_t size);
+
+    // contiguous free space after the stored data
+    MemoryBuffer get_write_buffer();
+    void commit(size_t size);
+
+    // contiguous data at the front
+    MemoryBuffer get_read_buffer() const;
+    void consume(size_t size);
+
+    void clear(); // also releases the memory
+
+private:
+    void _allocate();
+    void _release();
+
+private:
+    uint8_t* _ptr;
+    size_t _capacity;
+    size_t _head;
+    size_t _size;
+
+}; // class RingBuffer
+
+} // namespace sockspp
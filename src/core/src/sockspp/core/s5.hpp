@@ -80,11 +80,22 @@ public:
     }
 }; // class CommandMessage
 
-// Do we even need a separate class for udp?
+// FRAG is 0 for a standalone datagram, else the position of the
+// fragment in its sequence (1 to 127), the high bit marks the last one
 class S5UDPHeader : public S5R_Base
 {
 public:
     S5UDPHeader(void* data) : S5R_Base(data) {}
+
+    inline uint8_t get_frag() const
+    {
+        return reinterpret_cast<uint8_t*>(get_data())[2];
+    }
+
+    inline void set_frag(uint8_t frag)
+    {
+        reinterpret_cast<uint8_t*>(get_data())[2] = frag;
+    }
 }; // class S5UDPHeader
 
 } // namespace sockspp
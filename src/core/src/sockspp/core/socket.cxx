@@ -2,7 +2,9 @@
 #include <cstdint>
 #include <sockspp/core/socket.hpp>
 #include <sockspp/core/exceptions.hpp>
+#include <sockspp/core/errno.hpp>
 #include <stdexcept>
+#include <cerrno>
 
 #ifdef _WIN32
     #include <winsock2.h>
@@ -10,8 +12,10 @@
 #else
     #include <sys/socket.h>
     #include <sys/ioctl.h>
+    #include <sys/uio.h>
     #include <netinet/in.h>
     #include <netinet/tcp.h>
+    #include <netinet/udp.h>
     #include <arpa/inet.h>
     #include <unistd.h>
 #endif
@@ -133,6 +137,59 @@ bool Socket::set_keepalive(bool enabled)
     );
 }
 
+bool Socket::set_reuseport(bool enabled)
+{
+#ifdef SO_REUSEPORT
+    int state = enabled ? 1 : 0;
+    return 0 == setsockopt(
+        _fd,
+        SOL_SOCKET,
+        SO_REUSEPORT,
+        reinterpret_cast<const char*>(&state),
+        sizeof(state)
+    );
+#else
+    return false;
+#endif
+}
+
+bool Socket::set_defer_accept(int seconds)
+{
+#if defined(__linux__) && defined(TCP_DEFER_ACCEPT)
+    return 0 == setsockopt(
+        _fd,
+        IPPROTO_TCP,
+        TCP_DEFER_ACCEPT,
+        &seconds,
+        sizeof(seconds)
+    );
+#else
+    return false;
+#endif
+}
+
+bool Socket::set_udp_gro(bool enabled)
+{
+#if defined(__linux__) && defined(UDP_GRO)
+    int state = enabled ? 1 : 0;
+    return 0 == setsockopt(_fd, SOL_UDP, UDP_GRO, &state, sizeof(state));
+#else
+    return false;
+#endif
+}
+
+bool Socket::has_udp_gso() const
+{
+#if defined(__linux__) && defined(UDP_SEGMENT)
+    // the option exists since Linux 4.18
+    int size = 0;
+    socklen_t length = sizeof(size);
+    return 0 == getsockopt(_fd, SOL_UDP, UDP_SEGMENT, &size, &length);
+#else
+    return false;
+#endif
+}
+
 void Socket::connect(const std::string& ip, uint16_t port)
 {
     sockaddr_storage addr;
@@ -190,6 +247,37 @@ Socket Socket::accept(SocketInfo* info)
     return Socket(new_socket);
 }
 
+int Socket::accept(Socket& client, SocketInfo* info)
+{
+    sockaddr_storage addr;
+    socklen_t addr_len = sizeof(addr);
+
+#if defined(__linux__)
+    int new_socket = ::accept4(
+        _fd,
+        reinterpret_cast<sockaddr*>(&addr),
+        &addr_len,
+        SOCK_NONBLOCK | SOCK_CLOEXEC
+    );
+#else
+    int new_socket = ::accept(_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len);
+#endif
+
+    if (new_socket == -1)
+        return -1;
+
+    client = Socket(new_socket);
+
+#if !defined(__linux__)
+    client.set_blocking(false);
+#endif
+
+    if (info)
+        info->from(&addr);
+
+    return 0;
+}
+
 int Socket::recv(MemoryBuffer& buffer, int flags)
 {
     int size = ::recv(
@@ -336,6 +424,64 @@ int Socket::send_to(
     );
 }
 
+int Socket::send_to(
+    const MemoryBuffer* buffers,
+    size_t count,
+    void* sock_addr,
+    int sock_addr_len,
+    int flags
+) {
+    if (count > SOCKSPP_SOCKET_MAX_BUFFERS)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+#ifdef _WIN32
+    WSABUF wsa_buffers[SOCKSPP_SOCKET_MAX_BUFFERS];
+
+    for (size_t i = 0; i < count; i++)
+    {
+        wsa_buffers[i].buf = buffers[i].as<char*>();
+        wsa_buffers[i].len = static_cast<ULONG>(buffers[i].get_size());
+    }
+
+    DWORD size = 0;
+
+    if (WSASendTo(
+        _fd,
+        wsa_buffers,
+        static_cast<DWORD>(count),
+        &size,
+        flags,
+        reinterpret_cast<sockaddr*>(sock_addr),
+        sock_addr_len,
+        nullptr,
+        nullptr
+    ) == SOCKET_ERROR) {
+        return -1;
+    }
+
+    return static_cast<int>(size);
+#else
+    iovec iov[SOCKSPP_SOCKET_MAX_BUFFERS];
+
+    for (size_t i = 0; i < count; i++)
+    {
+        iov[i].iov_base = buffers[i].get_ptr();
+        iov[i].iov_len = buffers[i].get_size();
+    }
+
+    msghdr msg = {};
+    msg.msg_name = sock_addr;
+    msg.msg_namelen = sock_addr_len;
+    msg.msg_iov = iov;
+    msg.msg_iovlen = count;
+
+    return ::sendmsg(_fd, &msg, flags);
+#endif // _WIN32
+}
+
 void Socket::close()
 {
     if (_fd != -1)
@@ -369,6 +515,24 @@ int Socket::get_fd() const
     return _fd;
 }
 
+int Socket::get_error() const
+{
+    int error = 0;
+    socklen_t error_len = sizeof(error);
+
+    if (getsockopt(
+            _fd,
+            SOL_SOCKET,
+            SO_ERROR,
+            reinterpret_cast<char*>(&error),
+            &error_len) != 0)
+    {
+        return sockerrno;
+    }
+
+    return error;
+}
+
 int Socket::detach()
 {
     int fd = _fd;
@@ -5,6 +5,9 @@
 #include <string>
 #include <cstdint>
 
+// most buffers gathered into one datagram by Socket::send_to
+#define SOCKSPP_SOCKET_MAX_BUFFERS 8
+
 namespace sockspp
 {
 
@@ -28,6 +31,16 @@ public:
     bool set_blocking(bool enabled);
     bool set_nodelay(bool enabled);
     bool set_keepalive(bool enabled);
+    bool set_reuseport(bool enabled);
+    // listener: connections are accepted once they have data
+    // (TCP_DEFER_ACCEPT, Linux), false if unsupported
+    bool set_defer_accept(int seconds);
+
+    // udp offloads (Linux): GRO lets the kernel coalesce the datagrams of
+    // a sender, GSO split one send into datagrams (see DatagramBatch).
+    // false if the system doesn't have them
+    bool set_udp_gro(bool enabled);
+    bool has_udp_gso() const;
 
     void connect(const std::string& ip, uint16_t port);
     int connect(void* sock_addr, int sock_addr_len);
@@ -35,6 +48,9 @@ public:
     int bind(void* sock_addr, int sock_addr_len);
     void listen(int count);
     Socket accept(SocketInfo* info = nullptr);
+    // the client socket comes non-blocking and close-on-exec (accept4()
+    // on Linux), -1 when no connection is waiting (errno is set)
+    int accept(Socket& client, SocketInfo* info = nullptr);
 
     int recv(MemoryBuffer& buffer, int flags = 0);
     int recv(char* buffer, size_t size, int flags = 0);
@@ -57,12 +73,21 @@ public:
         int sock_addr_len,
         int flags = 0
     );
+    // the buffers are sent as one datagram, without copying them
+    int send_to(
+        const MemoryBuffer* buffers,
+        size_t count,
+        void* sock_addr,
+        int sock_addr_len,
+        int flags = 0
+    );
 
     void close();
     int shutdown(int mode = -1);
 
     int get_fd() const;
     int detach();
+    int get_error() const; // pending error (SO_ERROR), clears it
 
     SocketInfo get_bound_address() const;
     SocketInfo get_peer_address() const;
@@ -0,0 +1,275 @@
+#include "timer_wheel.hpp"
+
+#include <bit>
+#include <chrono>
+#include <climits>
+#include <cstring>
+
+namespace sockspp
+{
+
+Timer::Timer()
+    : _wheel(nullptr)
+    , _prev(nullptr)
+    , _next(nullptr)
+    , _expires(0)
+    , _level(0)
+    , _slot(0) {}
+
+Timer::Timer(Callback&& callback)
+    : Timer()
+{
+    _callback = std::move(callback);
+}
+
+Timer::~Timer()
+{
+    cancel();
+}
+
+void Timer::set_callback(Callback&& callback)
+{
+    _callback = std::move(callback);
+}
+
+bool Timer::is_armed() const
+{
+    return _wheel != nullptr;
+}
+
+void Timer::cancel()
+{
+    if (_wheel)
+        _wheel->cancel(*this);
+}
+
+TimerWheel::TimerWheel(uint32_t tick)
+    : _tick(0)
+    , _tick_ms(tick ? tick : 1)
+    , _size(0)
+{
+    std::memset(_slots, 0, sizeof(_slots));
+    std::memset(_occupied, 0, sizeof(_occupied));
+    _start = now();
+    _time = _start;
+}
+
+TimerWheel::~TimerWheel()
+{
+    for (int level = 0; level < LEVELS; level++)
+    {
+        for (int slot = 0; slot < SLOTS; slot++)
+        {
+            while (Timer* timer = _slots[level][slot])
+            {
+                _unlink(*timer);
+                timer->_wheel = nullptr;
+            }
+        }
+    }
+}
+
+uint64_t TimerWheel::now()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+uint64_t TimerWheel::get_time() const
+{
+    return _time;
+}
+
+size_t TimerWheel::get_size() const
+{
+    return _size;
+}
+
+void TimerWheel::arm(Timer& timer, uint64_t timeout)
+{
+    if (timer._wheel)
+        timer._wheel->cancel(timer);
+
+    // round up, a timer must not fire before its timeout
+    uint64_t expires = (_time - _start + timeout + _tick_ms - 1) / _tick_ms;
+    timer._expires = expires > _tick ? expires : _tick + 1;
+    timer._wheel = this;
+    _size++;
+
+    _insert(timer);
+}
+
+void TimerWheel::cancel(Timer& timer)
+{
+    if (timer._wheel != this)
+        return;
+
+    _unlink(timer);
+    timer._wheel = nullptr;
+    _size--;
+}
+
+void TimerWheel::advance()
+{
+    advance(now());
+}
+
+void TimerWheel::advance(uint64_t time)
+{
+    if (time < _time)
+        return;
+
+    _time = time;
+    uint64_t target = (_time - _start) / _tick_ms;
+
+    while (_tick < target)
+    {
+        // jump straight to the next tick that has something to do
+        uint64_t ticks = _size ? _ticks_to_next() : UINT64_MAX;
+
+        if (ticks > target - _tick)
+        {
+            _tick = target;
+            break;
+        }
+
+        _tick += ticks;
+
+        // move timers down from the outer levels whose slot starts now
+        for (int level = LEVELS - 1; level > 0; level--)
+        {
+            int shift = SLOT_BITS * level;
+
+            if (!(_tick & ((1ull << shift) - 1)))
+            {
+                _cascade(level, (_tick >> shift) & (SLOTS - 1));
+            }
+        }
+
+        _expire(_tick & (SLOTS - 1));
+    }
+}
+
+int TimerWheel::get_timeout() const
+{
+    if (!_size)
+        return -1;
+
+    uint64_t due = _start + (_tick + _ticks_to_next()) * _tick_ms;
+
+    if (due <= _time)
+        return 0;
+
+    uint64_t timeout = due - _time;
+    return timeout > INT_MAX ? INT_MAX : static_cast<int>(timeout);
+}
+
+void TimerWheel::_insert(Timer& timer)
+{
+    uint64_t expires = timer._expires > _tick ? timer._expires : _tick;
+    uint64_t delta = expires - _tick;
+    int level = 0;
+
+    while (level < LEVELS - 1 && delta >= (1ull << (SLOT_BITS * (level + 1))))
+    {
+        level++;
+    }
+
+    if (delta >= (1ull << (SLOT_BITS * LEVELS)))
+    {
+        // beyond the range of the wheel, park it in the farthest
+        // slot, it will be moved again when that slot is reached
+        expires = _tick + (1ull << (SLOT_BITS * LEVELS)) - 1;
+    }
+
+    int slot = (expires >> (SLOT_BITS * level)) & (SLOTS - 1);
+    Timer*& head = _slots[level][slot];
+
+    timer._level = level;
+    timer._slot = slot;
+    timer._prev = nullptr;
+    timer._next = head;
+
+    if (head)
+        head->_prev = &timer;
+
+    head = &timer;
+    _occupied[level] |= 1ull << slot;
+}
+
+void TimerWheel::_unlink(Timer& timer)
+{
+    if (timer._prev)
+        timer._prev->_next = timer._next;
+    else
+        _slots[timer._level][timer._slot] = timer._next;
+
+    if (timer._next)
+        timer._next->_prev = timer._prev;
+
+    if (!_slots[timer._level][timer._slot])
+        _occupied[timer._level] &= ~(1ull << timer._slot);
+
+    timer._prev = nullptr;
+    timer._next = nullptr;
+}
+
+void TimerWheel::_cascade(int level, int slot)
+{
+    while (Timer* timer = _slots[level][slot])
+    {
+        _unlink(*timer);
+        _insert(*timer);
+    }
+}
+
+void TimerWheel::_expire(int slot)
+{
+    // callbacks may arm and cancel any timer, including this one,
+    // so the slot is popped one timer at a time
+    while (Timer* timer = _slots[0][slot])
+    {
+        _unlink(*timer);
+
+        if (timer->_expires > _tick)
+        {
+            // parked timer that is still too far away
+            _insert(*timer);
+            continue;
+        }
+
+        timer->_wheel = nullptr;
+        _size--;
+
+        if (timer->_callback)
+            timer->_callback();
+    }
+}
+
+uint64_t TimerWheel::_ticks_to_next() const
+{
+    uint64_t ticks = UINT64_MAX;
+
+    for (int level = 0; level < LEVELS; level++)
+    {
+        if (!_occupied[level])
+            continue;
+
+        // the first slot boundary of this level after the current tick
+        // and the distance (in slots) to the next non-empty slot
+        int shift = SLOT_BITS * level;
+        uint64_t boundary = ((_tick >> shift) + 1) << shift;
+        int index = (boundary >> shift) & (SLOTS - 1);
+        int distance = std::countr_zero(std::rotr(_occupied[level], index));
+
+        uint64_t level_ticks = boundary + (uint64_t(distance) << shift) - _tick;
+
+        if (level_ticks < ticks)
+            ticks = level_ticks;
+    }
+
+    return ticks;
+}
+
+} // namespace sockspp
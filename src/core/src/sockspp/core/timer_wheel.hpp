@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+namespace sockspp
+{
+
+class TimerWheel;
+
+// Intrusive timer node, armed on a TimerWheel.
+// A timer is disarmed automatically when destroyed.
+class Timer
+{
+public:
+    using Callback = std::function<void()>;
+
+    Timer();
+    Timer(Callback&& callback);
+    Timer(const Timer& other) = delete;
+    ~Timer();
+
+    void set_callback(Callback&& callback);
+    bool is_armed() const;
+    void cancel();
+
+private:
+    Callback _callback;
+    TimerWheel* _wheel;
+    Timer* _prev;
+    Timer* _next;
+    uint64_t _expires; // tick
+    uint8_t _level;
+    uint8_t _slot;
+
+    friend class TimerWheel;
+}; // class Timer
+
+// Hierarchical timing wheel (4 levels of 64 slots). Arming and
+// cancelling a timer are O(1). The event loop sleeps for get_timeout()
+// milliseconds at most and calls advance() after every poll to fire
+// expired timers; timers never fire early, but up to one tick late.
+class TimerWheel
+{
+public:
+    TimerWheel(uint32_t tick = 10); // ms per tick
+    TimerWheel(const TimerWheel& other) = delete;
+    ~TimerWheel();
+
+    // monotonic clock (ms)
+    static uint64_t now();
+
+    // time of the last advance() (ms), cheap to read on the hot path
+    uint64_t get_time() const;
+    size_t get_size() const;
+
+    // (re)arms the timer to fire `timeout` ms after get_time()
+    void arm(Timer& timer, uint64_t timeout);
+    void cancel(Timer& timer);
+
+    // fires every timer expired up to now()
+    void advance();
+    void advance(uint64_t time);
+
+    // ms until the next timer has to be processed, -1 if there is none
+    int get_timeout() const;
+
+private:
+    void _insert(Timer& timer);
+    void _unlink(Timer& timer);
+    void _cascade(int level, int slot);
+    void _expire(int slot);
+    uint64_t _ticks_to_next() const;
+
+private:
+    static constexpr int LEVELS = 4;
+    static constexpr int SLOT_BITS = 6;
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+
+    Timer* _slots[LEVELS][SLOTS];
+    uint64_t _occupied[LEVELS]; // bitmap of non-empty slots
+    uint64_t _start; // ms at tick 0
+    uint64_t _time;
+    uint64_t _tick;
+    uint32_t _tick_ms;
+    size_t _size;
+
+}; // class TimerWheel
+
+} // namespace sockspp
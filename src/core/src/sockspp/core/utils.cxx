@@ -32,4 +32,31 @@ bool is_ip_address(const std::string& address)
         || is_ipv6_address(address);
 }
 
+uint32_t crc32(const void* data, size_t size, uint32_t crc)
+{
+    static const auto table = []() {
+        struct { uint32_t entries[256]; } table;
+
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t value = i;
+
+            for (int bit = 0; bit < 8; bit++)
+                value = (value & 1) ? (value >> 1) ^ 0xEDB88320u : value >> 1;
+
+            table.entries[i] = value;
+        }
+
+        return table;
+    }();
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+
+    for (size_t i = 0; i < size; i++)
+        crc = table.entries[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+
+    return ~crc;
+}
+
 } // namespace sockspp
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string>
+#include <cstddef>
+#include <cstdint>
 
 namespace sockspp
 {
@@ -9,4 +11,7 @@ bool is_ipv4_address(const std::string& address);
 bool is_ipv6_address(const std::string& address);
 bool is_ip_address(const std::string& address);
 
+// CRC-32 (IEEE 802.3), pass the previous result to continue a checksum
+uint32_t crc32(const void* data, size_t size, uint32_t crc = 0);
+
 } // namespace sockspp
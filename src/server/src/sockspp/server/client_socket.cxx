@@ -10,8 +10,7 @@ namespace sockspp::server
 ClientSocket::ClientSocket(Socket&& sock)
     : SessionSocket(std::move(sock))
 {
-    Socket& _sock = this->get_socket();
-    _sock.set_blocking(false);
+    // already non-blocking, see Socket::accept()
 }
 
 bool ClientSocket::process_event(Event::Flags event_flags)
@@ -1,13 +1,92 @@
 #pragma once
 
-// number of incoming tcp connections in the accept queue
-#define SOCKSPP_SERVER_LISTEN 128
-
 // initial available space for server poll result
 #define SOCKSPP_SERVER_INITIAL_POLL_RESULT_SIZE 128
 
-// buffer size on stack for each session (doubles for udp)
+// preallocated sessions per worker when the session count is unlimited
+#define SOCKSPP_WORKER_INITIAL_POOL_SIZE 256
+
+// resolution of session timeouts (ms)
+#define SOCKSPP_WORKER_TIMER_TICK 10
+
+// the listener is left alone this long (ms) when accept runs out of
+// descriptors or memory, the failures are reported once per interval
+#define SOCKSPP_WORKER_ACCEPT_BACKOFF 100
+#define SOCKSPP_WORKER_ACCEPT_LOG_INTERVAL 5000
+
+// buffer size on stack for each session,
+// also the minimum size of the relay ring buffers
 #define SOCKSPP_SESSION_SOCKET_BUFFER_SIZE 8192
 
-// max number of dns queries allowed at the same time per session
-#define SOCKSPP_SESSION_MAX_DNS_SOCKETS 5
+// largest udp datagram relayed, nothing is truncated
+#define SOCKSPP_SESSION_UDP_DATAGRAM_SIZE 65535
+
+// room for the socks header of an ip address in front of a datagram
+#define SOCKSPP_SESSION_UDP_HEADROOM 22
+
+// upper bound of the udp batch size (UIO_MAXIOV)
+#define SOCKSPP_SESSION_UDP_MAX_BATCH 1024
+
+// udp datagrams sent to a domain name wait for its resolution,
+// up to this many per name and this many names per association
+#define SOCKSPP_SESSION_UDP_QUEUE_SIZE 16
+#define SOCKSPP_SESSION_UDP_PENDING_NAMES 16
+
+// a fragmented udp datagram is dropped if it isn't complete
+// after this long (ms, RFC 1928 asks for at least 5 s)
+#define SOCKSPP_SESSION_UDP_REASSEMBLY_TIMEOUT 5000
+
+// capacity of each splice() pipe of a session (splice relay mode)
+#define SOCKSPP_SESSION_SPLICE_PIPE_SIZE 65536
+
+// number of independently locked parts of the dns cache
+#define SOCKSPP_DNS_CACHE_SHARDS 16
+
+// upper bound for the ttl of cached dns answers (seconds)
+#define SOCKSPP_DNS_CACHE_MAX_TTL 86400
+
+// popular names are resolved again in the last part of their ttl (%),
+// and once more after a while (ms) if that refresh got no answer
+#define SOCKSPP_DNS_CACHE_REFRESH_WINDOW 20
+#define SOCKSPP_DNS_CACHE_REFRESH_RETRY 1000
+
+// hosts file of the system, consulted before the nameservers
+#ifdef _WIN32
+    #define SOCKSPP_SYSTEM_HOSTS_FILE "C:\\Windows\\System32\\drivers\\etc\\hosts"
+#else
+    #define SOCKSPP_SYSTEM_HOSTS_FILE "/etc/hosts"
+#endif
+
+// how often the hosts files are checked for changes (ms)
+#define SOCKSPP_HOSTS_CHECK_INTERVAL 2000
+
+// how long to wait for AAAA records after a positive A answer (ms)
+#define SOCKSPP_RESOLVER_RESOLUTION_DELAY 50
+
+// how long a dns query may stay unanswered when --dns-timeout is 0 (ms)
+#define SOCKSPP_RESOLVER_QUERY_TIMEOUT 30000
+
+// addresses of one dns response kept at most
+#define SOCKSPP_RESOLVER_MAX_ADDRESSES 64
+
+// nameservers used by the resolver at most
+#define SOCKSPP_RESOLVER_MAX_NAMESERVERS 8
+
+// assumed round trip time of a nameserver not heard from yet (ms)
+#define SOCKSPP_RESOLVER_INITIAL_RTT 100
+
+// bounds of the retransmission timeout of a query (ms), it starts at
+// twice the smoothed round trip time of the nameserver and doubles
+// with every retransmission
+#define SOCKSPP_RESOLVER_MIN_RTO 200
+#define SOCKSPP_RESOLVER_MAX_RTO 3000
+
+// unanswered queries in a row after which a nameserver is skipped,
+// and for how long (ms) before it gets a chance again
+#define SOCKSPP_RESOLVER_MAX_FAILURES 3
+#define SOCKSPP_RESOLVER_SERVER_HOLDDOWN 30000
+
+// queries waiting to be written to the tcp connection of a nameserver
+// (bytes), and how long the connection stays open once idle (ms)
+#define SOCKSPP_RESOLVER_TCP_BUFFER_SIZE 8192
+#define SOCKSPP_RESOLVER_TCP_IDLE_TIMEOUT 10000
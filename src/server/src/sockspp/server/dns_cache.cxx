@@ -0,0 +1,461 @@
+#include "dns_cache.hpp"
+#include "utils.hpp"
+#include "defs.hpp"
+
+#include <sockspp/core/utils.hpp>
+#include <sockspp/core/log.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+// "SDNC" + format version, entry count, size of the records, wall clock
+// time of the snapshot (ms since the epoch), CRC-32 of the records
+#define SOCKSPP_DNS_CACHE_FILE_MAGIC 0x434E4453u
+#define SOCKSPP_DNS_CACHE_FILE_VERSION 1
+#define SOCKSPP_DNS_CACHE_FILE_HEADER_SIZE 32
+
+// record: ttl left (ms), name length, IPv4 and IPv6 address count,
+// flags, then the addresses, the name and padding up to 4 bytes
+#define SOCKSPP_DNS_CACHE_RECORD_HEADER_SIZE 8
+#define SOCKSPP_DNS_CACHE_RECORD_PROTECTED 1
+
+namespace sockspp::server
+{
+
+static inline void _put32(uint8_t* data, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+        data[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+static inline uint32_t _get32(const uint8_t* data)
+{
+    return static_cast<uint32_t>(data[0])
+        | (static_cast<uint32_t>(data[1]) << 8)
+        | (static_cast<uint32_t>(data[2]) << 16)
+        | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+static inline uint64_t _get_wall_time()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+DnsCache::DnsCache(
+    size_t capacity,
+    uint32_t negative_ttl,
+    uint32_t refresh_hits,
+    uint32_t refresh_rate
+)   : _shards(SOCKSPP_DNS_CACHE_SHARDS)
+    , _negative_ttl(negative_ttl)
+    , _refresh_hits(refresh_rate ? refresh_hits : 0)
+    , _refresh_rate(refresh_rate)
+    , _refresh_tokens(refresh_rate * 1000ull)
+    , _refresh_last_time(0)
+{
+    _shard_capacity = std::max<size_t>(capacity / SOCKSPP_DNS_CACHE_SHARDS, 1);
+
+    // 80% of a shard is reserved for names that were hit at least twice
+    _protected_capacity = _shard_capacity * 4 / 5;
+}
+
+DnsCache::Status DnsCache::lookup(
+    const std::string& name,
+    uint16_t port,
+    uint64_t time,
+    std::vector<IPAddress>& addresses
+) {
+    std::string key = normalize_domain_name(name);
+    Shard& shard = _get_shard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto found = shard.entries.find(key);
+
+    if (found == shard.entries.end())
+        return Status::Miss;
+
+    EntryList::iterator it = found->second;
+
+    if (it->expires <= time)
+    {
+        _erase(shard, it);
+        return Status::Miss;
+    }
+
+    _promote(shard, it);
+
+    if (it->addresses.empty())
+        return Status::Negative;
+
+    Status status = Status::Hit;
+
+    // only the hits of the refresh window count, a name that was
+    // popular early on and went cold isn't resolved again
+    if (it->refresh_time <= time)
+        it->hits++;
+
+    if (_refresh_hits
+        && it->hits >= _refresh_hits
+        && it->refresh_time <= time
+        && _take_refresh_token(time))
+    {
+        // one refresh at a time, unless it gets no answer
+        it->refresh_time = time + SOCKSPP_DNS_CACHE_REFRESH_RETRY;
+        status = Status::Refresh;
+    }
+
+    for (const IPAddress& address : it->addresses)
+    {
+        addresses.emplace_back(
+            address.get_version(),
+            address.get_address(),
+            port
+        );
+    }
+
+    return status;
+}
+
+void DnsCache::insert(
+    const std::string& name,
+    const std::vector<IPAddress>& addresses,
+    uint32_t ttl,
+    uint64_t time
+) {
+    if (addresses.empty())
+        ttl = std::min(ttl, _negative_ttl);
+    else
+        ttl = std::min<uint32_t>(ttl, SOCKSPP_DNS_CACHE_MAX_TTL);
+
+    if (!ttl)
+        return;
+
+    std::string key = normalize_domain_name(name);
+    Shard& shard = _get_shard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto found = shard.entries.find(key);
+    EntryList::iterator it;
+
+    if (found != shard.entries.end())
+    {
+        // refreshed by another session, keep its segment
+        it = found->second;
+        it->addresses.clear();
+    }
+    else
+    {
+        shard.probation.push_front(Entry{ key, {}, 0, false });
+        it = shard.probation.begin();
+        shard.entries.emplace(key, it);
+    }
+
+    it->expires = time + ttl * 1000ull;
+    it->refresh_time = it->expires
+        - ttl * 10ull * SOCKSPP_DNS_CACHE_REFRESH_WINDOW;
+    it->hits = 0;
+    it->addresses.reserve(addresses.size());
+
+    for (const IPAddress& address : addresses)
+    {
+        it->addresses.emplace_back(
+            address.get_version(),
+            address.get_address(),
+            0
+        );
+    }
+
+    _evict(shard);
+}
+
+size_t DnsCache::get_size() const
+{
+    size_t size = 0;
+
+    for (const Shard& shard : _shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size += shard.entries.size();
+    }
+
+    return size;
+}
+
+bool DnsCache::save(const std::string& path, uint64_t time) const
+{
+    std::vector<uint8_t> data(SOCKSPP_DNS_CACHE_FILE_HEADER_SIZE);
+    uint32_t count = 0;
+
+    for (const Shard& shard : _shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        // most recently used first, the order they are loaded back in
+        for (const EntryList* list : { &shard.protected_, &shard.probation })
+        {
+            for (const Entry& entry : *list)
+            {
+                if (entry.expires <= time)
+                    continue;
+
+                uint8_t counts[2] = { 0, 0 };
+
+                for (const IPAddress& address : entry.addresses)
+                {
+                    uint8_t& n = counts[
+                        address.get_version() == IPAddress::Version::IPv6
+                    ];
+                    n += n < UINT8_MAX;
+                }
+
+                size_t offset = data.size();
+                size_t size = SOCKSPP_DNS_CACHE_RECORD_HEADER_SIZE
+                    + counts[0] * 4
+                    + counts[1] * 16
+                    + entry.name.size();
+
+                data.resize(offset + ((size + 3) & ~size_t(3)));
+
+                uint8_t* record = data.data() + offset;
+                _put32(record, static_cast<uint32_t>(entry.expires - time));
+                record[4] = static_cast<uint8_t>(entry.name.size());
+                record[5] = counts[0];
+                record[6] = counts[1];
+                record[7] = entry.is_protected
+                    ? SOCKSPP_DNS_CACHE_RECORD_PROTECTED
+                    : 0;
+
+                uint8_t* out = record + SOCKSPP_DNS_CACHE_RECORD_HEADER_SIZE;
+
+                for (int v6 = 0; v6 < 2; v6++)
+                {
+                    uint8_t n = 0;
+
+                    for (const IPAddress& address : entry.addresses)
+                    {
+                        if ((address.get_version() == IPAddress::Version::IPv6) != v6
+                            || n == counts[v6])
+                        {
+                            continue;
+                        }
+
+                        memcpy(out, address.get_address(), v6 ? 16 : 4);
+                        out += v6 ? 16 : 4;
+                        n++;
+                    }
+                }
+
+                memcpy(out, entry.name.data(), entry.name.size());
+                count++;
+            }
+        }
+    }
+
+    uint8_t* header = data.data();
+    uint64_t wall_time = _get_wall_time();
+    size_t records_size = data.size() - SOCKSPP_DNS_CACHE_FILE_HEADER_SIZE;
+
+    _put32(header, SOCKSPP_DNS_CACHE_FILE_MAGIC);
+    _put32(header + 4, SOCKSPP_DNS_CACHE_FILE_VERSION);
+    _put32(header + 8, count);
+    _put32(header + 12, static_cast<uint32_t>(records_size));
+    _put32(header + 16, static_cast<uint32_t>(wall_time));
+    _put32(header + 20, static_cast<uint32_t>(wall_time >> 32));
+    _put32(header + 24, crc32(header + SOCKSPP_DNS_CACHE_FILE_HEADER_SIZE, records_size));
+    _put32(header + 28, 0);
+
+    // a crash while writing leaves the previous snapshot intact
+    std::string tmp_path = path + ".tmp";
+
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+
+        if (!file.write(reinterpret_cast<const char*>(data.data()), data.size())
+            || !file.flush())
+        {
+            return false;
+        }
+    }
+
+    return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+size_t DnsCache::load(const std::string& path, uint64_t time)
+{
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file)
+        return 0;
+
+    std::vector<uint8_t> data(
+        (std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>()
+    );
+
+    if (data.size() < SOCKSPP_DNS_CACHE_FILE_HEADER_SIZE)
+    {
+        LOGW("DNS cache snapshot %s is invalid, ignored", path.c_str());
+        return 0;
+    }
+
+    const uint8_t* header = data.data();
+    size_t records_size = data.size() - SOCKSPP_DNS_CACHE_FILE_HEADER_SIZE;
+
+    if (_get32(header) != SOCKSPP_DNS_CACHE_FILE_MAGIC
+        || _get32(header + 4) != SOCKSPP_DNS_CACHE_FILE_VERSION
+        || _get32(header + 12) != records_size
+        || _get32(header + 24) != crc32(header + SOCKSPP_DNS_CACHE_FILE_HEADER_SIZE, records_size))
+    {
+        LOGW("DNS cache snapshot %s is invalid, ignored", path.c_str());
+        return 0;
+    }
+
+    uint64_t saved_time = _get32(header + 16)
+        | (static_cast<uint64_t>(_get32(header + 20)) << 32);
+    uint64_t wall_time = _get_wall_time();
+    uint64_t elapsed = wall_time > saved_time ? wall_time - saved_time : 0;
+
+    uint32_t count = _get32(header + 8);
+    size_t offset = SOCKSPP_DNS_CACHE_FILE_HEADER_SIZE;
+    size_t loaded = 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (offset + SOCKSPP_DNS_CACHE_RECORD_HEADER_SIZE > data.size())
+            break;
+
+        const uint8_t* record = data.data() + offset;
+        uint32_t ttl = _get32(record);
+        size_t name_length = record[4];
+        size_t counts[2] = { record[5], record[6] };
+        size_t size = SOCKSPP_DNS_CACHE_RECORD_HEADER_SIZE
+            + counts[0] * 4
+            + counts[1] * 16
+            + name_length;
+
+        if (!name_length || offset + size > data.size())
+            break;
+
+        offset += (size + 3) & ~size_t(3);
+
+        if (ttl <= elapsed)
+            continue;
+
+        const uint8_t* addresses = record + SOCKSPP_DNS_CACHE_RECORD_HEADER_SIZE;
+        std::string key(
+            reinterpret_cast<const char*>(addresses + counts[0] * 4 + counts[1] * 16),
+            name_length
+        );
+
+        Shard& shard = _get_shard(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        if (shard.entries.size() >= _shard_capacity || shard.entries.contains(key))
+            continue;
+
+        bool is_protected = (record[7] & SOCKSPP_DNS_CACHE_RECORD_PROTECTED)
+            && shard.protected_.size() < _protected_capacity;
+        EntryList& list = is_protected ? shard.protected_ : shard.probation;
+
+        list.push_back(Entry{ key, {}, time + ttl - elapsed, is_protected });
+        EntryList::iterator it = std::prev(list.end());
+
+        // the original ttl isn't known, the window is taken from what's left
+        it->refresh_time = it->expires
+            - (ttl - elapsed) / 100 * SOCKSPP_DNS_CACHE_REFRESH_WINDOW;
+        shard.entries.emplace(key, it);
+
+        it->addresses.reserve(counts[0] + counts[1]);
+
+        for (int v6 = 0; v6 < 2; v6++)
+        {
+            for (size_t j = 0; j < counts[v6]; j++)
+            {
+                it->addresses.emplace_back(
+                    v6 ? IPAddress::Version::IPv6 : IPAddress::Version::IPv4,
+                    const_cast<uint8_t*>(addresses),
+                    0
+                );
+                addresses += v6 ? 16 : 4;
+            }
+        }
+
+        loaded++;
+    }
+
+    return loaded;
+}
+
+DnsCache::Shard& DnsCache::_get_shard(const std::string& key)
+{
+    return _shards[std::hash<std::string>{}(key) % _shards.size()];
+}
+
+void DnsCache::_promote(Shard& shard, EntryList::iterator it)
+{
+    if (it->is_protected)
+    {
+        shard.protected_.splice(shard.protected_.begin(), shard.protected_, it);
+        return;
+    }
+
+    it->is_protected = true;
+    shard.protected_.splice(shard.protected_.begin(), shard.probation, it);
+
+    // the least recently used protected entry gets a second chance
+    // in probation instead of being dropped
+    if (shard.protected_.size() > _protected_capacity)
+    {
+        EntryList::iterator last = std::prev(shard.protected_.end());
+        last->is_protected = false;
+        shard.probation.splice(shard.probation.begin(), shard.protected_, last);
+    }
+}
+
+void DnsCache::_erase(Shard& shard, EntryList::iterator it)
+{
+    shard.entries.erase(it->name);
+
+    if (it->is_protected)
+        shard.protected_.erase(it);
+    else
+        shard.probation.erase(it);
+}
+
+void DnsCache::_evict(Shard& shard)
+{
+    while (shard.entries.size() > _shard_capacity)
+    {
+        EntryList& list = shard.probation.empty()
+            ? shard.protected_
+            : shard.probation;
+
+        _erase(shard, std::prev(list.end()));
+    }
+}
+
+bool DnsCache::_take_refresh_token(uint64_t time)
+{
+    std::lock_guard<std::mutex> lock(_refresh_mutex);
+
+    // refilled at the refresh rate, up to one second worth of tokens
+    _refresh_tokens = std::min<uint64_t>(
+        _refresh_tokens + (time - std::min(time, _refresh_last_time)) * _refresh_rate,
+        _refresh_rate * 1000ull
+    );
+    _refresh_last_time = std::max(_refresh_last_time, time);
+
+    if (_refresh_tokens < 1000)
+        return false;
+
+    _refresh_tokens -= 1000;
+    return true;
+}
+
+} // namespace sockspp::server
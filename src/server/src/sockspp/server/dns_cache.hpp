@@ -0,0 +1,120 @@
+#pragma once
+
+#include <sockspp/core/ip_address.hpp>
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+namespace sockspp::server
+{
+
+// Domain name -> addresses cache shared by all workers. Entries expire
+// after their record TTL, negative answers (NXDOMAIN / no data) are kept
+// for a bounded time too. The cache is split into shards with their own
+// lock, each shard is a segmented LRU: new names enter the probation
+// segment and only names hit again get into the protected one, so a burst
+// of one-off lookups can't flush the hot names.
+// The cache can be saved to a snapshot file and loaded back on startup,
+// the time elapsed in between is taken off the TTLs.
+// Names hit often enough in the last part of their TTL are due for
+// a refresh, so they are resolved again before they expire. Refreshes of all
+// workers share a token bucket that limits the load on the nameservers.
+class DnsCache
+{
+public:
+    enum class Status
+    {
+        Miss,
+        Hit,
+        Refresh, // hit, the name should be resolved again in the background
+        Negative
+    };
+
+public:
+    // refresh_hits: hits in the refresh window before a name is
+    // refreshed (0 = never),
+    // refresh_rate: refreshes per second at most
+    DnsCache(
+        size_t capacity,
+        uint32_t negative_ttl,
+        uint32_t refresh_hits = 0,
+        uint32_t refresh_rate = 0
+    );
+    DnsCache(const DnsCache& other) = delete;
+
+    // `time` is a monotonic time in ms (see TimerWheel::now()),
+    // found addresses are appended with the given port
+    Status lookup(
+        const std::string& name,
+        uint16_t port,
+        uint64_t time,
+        std::vector<IPAddress>& addresses
+    );
+
+    // no addresses = negative answer, its ttl is capped by negative_ttl
+    void insert(
+        const std::string& name,
+        const std::vector<IPAddress>& addresses,
+        uint32_t ttl,
+        uint64_t time
+    );
+
+    size_t get_size() const;
+
+    // binary snapshot: a versioned header with a CRC-32 of the records,
+    // little endian, records aligned to 4 bytes. Written to a temporary
+    // file first and renamed, false if it couldn't be written
+    bool save(const std::string& path, uint64_t time) const;
+
+    // names loaded from a snapshot, expired ones and the ones not
+    // fitting are skipped, 0 if the file is missing or invalid
+    size_t load(const std::string& path, uint64_t time);
+
+private:
+    struct Entry
+    {
+        std::string name;
+        std::vector<IPAddress> addresses;
+        uint64_t expires;
+        bool is_protected;
+        uint64_t refresh_time = 0; // start of the refresh window
+        uint32_t hits = 0;         // since the refresh window started
+    };
+
+    using EntryList = std::list<Entry>;
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        EntryList probation;
+        EntryList protected_;
+        std::unordered_map<std::string, EntryList::iterator> entries;
+    };
+
+    Shard& _get_shard(const std::string& key);
+    void _promote(Shard& shard, EntryList::iterator it);
+    void _erase(Shard& shard, EntryList::iterator it);
+    void _evict(Shard& shard);
+    bool _take_refresh_token(uint64_t time);
+
+private:
+    std::vector<Shard> _shards;
+    size_t _shard_capacity;
+    size_t _protected_capacity;
+    uint32_t _negative_ttl;
+    uint32_t _refresh_hits;
+    uint32_t _refresh_rate;
+
+    // token bucket of the refreshes, one token = 1000
+    std::mutex _refresh_mutex;
+    uint64_t _refresh_tokens;
+    uint64_t _refresh_last_time;
+
+}; // class DnsCache
+
+} // namespace sockspp::server
@@ -1,12 +1,12 @@
 #include "dns_socket.hpp"
-#include "session.hpp"
+#include "resolver.hpp"
+#include "defs.hpp"
 
 #include <sockspp/core/log.hpp>
 #include <sockspp/core/errno.hpp>
 
-#include <dnslib/dns.h>
-#include <dnslib/message.h>
-#include <dnslib/qs.h>
+#include <cstdint>
+#include <cstring>
 
 #ifdef _WIN32
     #include <winsock2.h>
@@ -19,74 +19,73 @@
 namespace sockspp::server
 {
 
-const char* _dns_rcodes[] = {
-    "No Error",
-    "Format Error",
-    "Server Failure",
-    "Name Error",
-    "Not Implemented",
-    "Refused"
-};
-
 DnsSocket::DnsSocket(
     Socket&& sock,
-    const std::string& domain_name,
-    uint16_t port,
-    sockspp::MemoryBuffer* buffer)
+    Resolver& resolver,
+    const IPAddress& nameserver,
+    uint16_t udp_payload_size)
     : SessionSocket(std::move(sock))
-    , _domain_name(domain_name)
-    , _port(port)
-{
-    if (buffer)
-    {
-        _buffer = sockspp::Buffer(buffer->get_size());
-        _buffer.copy_from(*buffer);
-    }
-}
+    , _resolver(resolver)
+    , _nameserver(nameserver)
+    , _udp_payload_size(udp_payload_size) {}
 
-const sockspp::Buffer& DnsSocket::get_buffer() const
+const IPAddress& DnsSocket::get_nameserver() const
 {
-    return _buffer;
+    return _nameserver;
 }
 
-int DnsSocket::query(const IPAddress& dns_address)
+static bool _is_same_address(const IPAddress& address, const sockaddr_storage& addr)
 {
-    dns::Message message;
-
-    message.setQr(0);
-    message.setOpCode(0);
-    auto qs = new dns::QuerySection(_domain_name);
-    qs->setType(dns::RDATA_A);
-    message.addQuery(qs);
-
-    char _buffer[dns::MAX_MSG_LEN];
-    uint32_t buffer_size = 0;
-    message.encode(_buffer, dns::MAX_MSG_LEN, buffer_size);
-    MemoryBuffer buffer(_buffer, buffer_size, dns::MAX_MSG_LEN);
+    if (addr.ss_family == AF_INET)
+    {
+        const sockaddr_in* s = reinterpret_cast<const sockaddr_in*>(&addr);
 
-    sockaddr_storage send_addr;
-    socklen_t send_addr_len;
+        return address.get_version() == IPAddress::Version::IPv4
+            && s->sin_port == address.get_netport()
+            && !memcmp(&s->sin_addr, address.get_address(), 4);
+    }
 
-    if (dns_address.get_version() == IPAddress::Version::IPv4)
+    if (addr.ss_family == AF_INET6)
     {
-        send_addr.ss_family = AF_INET;
-        sockaddr_in* s = reinterpret_cast<sockaddr_in*>(&send_addr);
-        s->sin_addr.s_addr =
-            *reinterpret_cast<uint32_t*>(dns_address.get_address());
-        s->sin_port = dns_address.get_netport();
-        send_addr_len = sizeof(sockaddr_in);
+        const sockaddr_in6* s = reinterpret_cast<const sockaddr_in6*>(&addr);
+
+        return address.get_version() == IPAddress::Version::IPv6
+            && s->sin6_port == address.get_netport()
+            && !memcmp(&s->sin6_addr, address.get_address(), 16);
     }
-    else
+
+    return false;
+}
+
+int DnsSocket::query(
+    uint16_t id,
+    const std::string& domain_name,
+    IPAddress::Version version
+) {
+    uint8_t _buffer[SOCKSPP_DNS_MAX_UDP_SIZE];
+
+    size_t size = DnsCodec::encode_query(
+        _buffer,
+        sizeof(_buffer),
+        id,
+        domain_name.data(),
+        domain_name.size(),
+        version == IPAddress::Version::IPv4 ? DnsType::A : DnsType::AAAA,
+        _udp_payload_size
+    );
+
+    if (!size)
     {
-        send_addr.ss_family = AF_INET6;
-        sockaddr_in6* s =
-            reinterpret_cast<sockaddr_in6*>(&send_addr);
-        s->sin6_port = dns_address.get_netport();
-        memcpy(&s->sin6_addr, dns_address.get_address(), sizeof(s->sin6_addr));
-        send_addr_len = sizeof(sockaddr_in6);
+        LOGW("DNS QUERY | invalid domain name: %s", domain_name.c_str());
+        return 0;
     }
 
-    LOGD("DNS QUERY | %s", _domain_name.c_str());
+    MemoryBuffer buffer(_buffer, size, sizeof(_buffer));
+
+    sockaddr_storage send_addr;
+    socklen_t send_addr_len = _nameserver.to_sockaddr(&send_addr);
+
+    LOGD("DNS QUERY | %s (id: %u)", domain_name.c_str(), id);
 
     return SessionSocket::send_to(
         buffer,
@@ -95,70 +94,201 @@ int DnsSocket::query(const IPAddress& dns_address)
     );
 }
 
-int DnsSocket::get_response(std::vector<IPAddress>* addresses)
-{
-    char _buffer[dns::MAX_MSG_LEN];
-    MemoryBuffer buffer(_buffer, 0, dns::MAX_MSG_LEN);
+int DnsSocket::get_response(
+    uint8_t* buffer,
+    size_t capacity,
+    DnsResponse* response
+) {
+    MemoryBuffer recv_buffer(buffer, 0, capacity);
 
-    int size = SessionSocket::recv_from(buffer, nullptr, nullptr);
+    sockaddr_storage recv_addr;
+    int recv_addr_len = sizeof(recv_addr);
 
-    if (size <= 0)
+    int size = SessionSocket::recv_from(recv_buffer, &recv_addr, &recv_addr_len);
+
+    if (size < 0)
     {
         return size;
     }
 
-    dns::Message message;
-    message.decode(_buffer, buffer.get_size());
+    if (!_is_same_address(_nameserver, recv_addr))
+    {
+        LOGW("DNS response from an unexpected address, dropped");
+        return 0;
+    }
+
+    if (!DnsCodec::decode_response(buffer, recv_buffer.get_size(), *response))
+    {
+        LOGW("DNS response malformed, dropped");
+        return 0;
+    }
+
+    return size;
+}
+
+bool DnsSocket::process_event(Event::Flags event_flags)
+{
+    return _resolver.process_event(this, event_flags);
+}
+
+DnsTcpSocket::DnsTcpSocket(
+    Socket&& sock,
+    Resolver& resolver,
+    const IPAddress& nameserver)
+    : SessionSocket(std::move(sock))
+    , _resolver(resolver)
+    , _nameserver(nameserver)
+    , _connected(false)
+    , _output(SOCKSPP_RESOLVER_TCP_BUFFER_SIZE)
+    , _input(new uint8_t[2 + SOCKSPP_DNS_MAX_MESSAGE_SIZE])
+    , _input_start(0)
+    , _input_size(0)
+    , _registered_events(static_cast<Event::Flags>(0)) {}
+
+const IPAddress& DnsTcpSocket::get_nameserver() const
+{
+    return _nameserver;
+}
+
+Timer& DnsTcpSocket::get_idle_timer()
+{
+    return _idle_timer;
+}
+
+bool DnsTcpSocket::connect()
+{
+    sockaddr_storage addr;
+    socklen_t addr_len = _nameserver.to_sockaddr(&addr);
+
+    int res = this->get_socket().connect(
+        reinterpret_cast<sockaddr*>(&addr),
+        addr_len
+    );
+
+    if (res < 0
+        && (sockerrno != SOCKSPP_EWOULDBLOCK)
+        && (sockerrno != SOCKSPP_EAGAIN)
+        && (sockerrno != SOCKSPP_EINPROGRESS))
+    {
+        LOGD("DNS TCP | ::connect(...) == -1 (errno == %d)", sockerrno);
+        return false;
+    }
+
+    return true;
+}
+
+bool DnsTcpSocket::is_connected() const
+{
+    return _connected;
+}
+
+void DnsTcpSocket::set_connected()
+{
+    _connected = true;
+}
+
+bool DnsTcpSocket::query(
+    uint16_t id,
+    const std::string& domain_name,
+    IPAddress::Version version
+) {
+    uint8_t _buffer[2 + SOCKSPP_DNS_MAX_UDP_SIZE];
+
+    // no EDNS, the size of a TCP answer is only limited by the prefix
+    size_t size = DnsCodec::encode_query(
+        _buffer + 2,
+        sizeof(_buffer) - 2,
+        id,
+        domain_name.data(),
+        domain_name.size(),
+        version == IPAddress::Version::IPv4 ? DnsType::A : DnsType::AAAA
+    );
+
+    if (!size || size + 2 > _output.get_free())
+        return false;
+
+    _buffer[0] = static_cast<uint8_t>(size >> 8);
+    _buffer[1] = static_cast<uint8_t>(size);
+    _output.write(_buffer, size + 2);
+
+    LOGD("DNS QUERY | %s (id: %u, tcp)", domain_name.c_str(), id);
+    return true;
+}
+
+bool DnsTcpSocket::has_pending_output() const
+{
+    return !_output.is_empty();
+}
 
-    for (auto answer : message.getAnswers())
+bool DnsTcpSocket::flush()
+{
+    while (!_output.is_empty())
     {
-        dns::eClass cls = answer->getClass();
+        MemoryBuffer buffer = _output.get_read_buffer();
+        int size = SessionSocket::send(buffer);
 
-        if (cls == dns::CLASS_IN)
+        if (size < 0)
         {
-            dns::eRDataType type = answer->getType();
-
-            if (type == dns::RDATA_A)
-            {
-                dns::RDataA* rdata = \
-                    reinterpret_cast<dns::RDataA*>(answer->getRData());
-
-                addresses->emplace_back(
-                    IPAddress::Version::IPv4,
-                    rdata->getAddress(),
-                    _port
-                );
-            }
-
-            if (type == dns::RDATA_AAAA)
-            {
-                dns::RDataAAAA* rdata = \
-                    reinterpret_cast<dns::RDataAAAA*>(answer->getRData());
-
-                addresses->emplace_back(
-                    IPAddress::Version::IPv6,
-                    rdata->getAddress(),
-                    _port
-                );
-            }
+            return (sockerrno == SOCKSPP_EWOULDBLOCK)
+                || (sockerrno == SOCKSPP_EAGAIN);
         }
+
+        _output.consume(size);
     }
 
-    if (addresses->empty())
+    return true;
+}
+
+int DnsTcpSocket::receive()
+{
+    // move the partial message left over to the front
+    if (_input_start)
     {
-        LOGE(
-            "DNS QUERY no answer. Domain: %s, reason: \"%s\"",
-            _domain_name.c_str(),
-            _dns_rcodes[message.getRCode()]
-        );
+        memmove(_input.get(), _input.get() + _input_start, _input_size);
+        _input_start = 0;
     }
 
+    MemoryBuffer buffer(
+        _input.get() + _input_size,
+        0,
+        2 + SOCKSPP_DNS_MAX_MESSAGE_SIZE - _input_size
+    );
+
+    int size = SessionSocket::recv(buffer);
+
+    if (size > 0)
+        _input_size += size;
+
     return size;
 }
 
-bool DnsSocket::process_event(Event::Flags event_flags)
+int DnsTcpSocket::get_response(DnsResponse* response)
+{
+    const uint8_t* data = _input.get() + _input_start;
+
+    if (_input_size < 2)
+        return -1;
+
+    size_t length = (data[0] << 8) | data[1];
+
+    if (_input_size < 2 + length)
+        return -1;
+
+    _input_start += 2 + length;
+    _input_size -= 2 + length;
+
+    if (!DnsCodec::decode_response(data + 2, length, *response))
+    {
+        LOGW("DNS response malformed, dropped");
+        return 0;
+    }
+
+    return static_cast<int>(length);
+}
+
+bool DnsTcpSocket::process_event(Event::Flags event_flags)
 {
-    return get_session().process_dns_event(event_flags, this);
+    return _resolver.process_event(this, event_flags);
 }
 
 } // namespace sockspp::server
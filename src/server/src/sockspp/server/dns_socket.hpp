@@ -2,40 +2,115 @@
 
 #include "session_socket.hpp"
 #include <sockspp/core/memory_buffer.hpp>
-#include <sockspp/core/buffer.hpp>
+#include <sockspp/core/ring_buffer.hpp>
 #include <sockspp/core/ip_address.hpp>
+#include <sockspp/core/timer_wheel.hpp>
+#include <sockspp/core/dns.hpp>
 
 #include <string>
 #include <vector>
+#include <memory>
 
 namespace sockspp::server
 {
 
-class Session;
+class Resolver;
 
+// UDP socket shared by all queries of a Resolver. It is not owned by a
+// session, so the events go to the resolver of the worker. Only replies
+// coming from the nameserver are accepted, matching them to queries by
+// transaction id is up to the resolver.
 class DnsSocket : public SessionSocket
 {
 public:
     DnsSocket(
         Socket&& sock,
+        Resolver& resolver,
+        const IPAddress& nameserver,
+        uint16_t udp_payload_size // EDNS0, 0 = none
+    );
+
+    using SessionSocket::get_socket;
+    const IPAddress& get_nameserver() const;
+
+    // asks for A (IPv4) or AAAA (IPv6) records
+    int query(
+        uint16_t id,
+        const std::string& domain_name,
+        IPAddress::Version version
+    );
+
+    // > 0: response from the nameserver received into `buffer` and
+    //      decoded into `response` (its address storage is set by
+    //      the caller)
+    //   0: datagram rejected (wrong source, not a response, malformed)
+    //  -1: socket error, EAGAIN once everything has been read
+    int get_response(uint8_t* buffer, size_t capacity, DnsResponse* response);
+
+    bool process_event(Event::Flags event_flags) override;
+
+private:
+    Resolver& _resolver;
+    IPAddress _nameserver;
+    uint16_t _udp_payload_size;
+
+}; // class DnsSocket
+
+// TCP connection to a nameserver (RFC 7766), for the answers that don't
+// fit in a datagram. Queries are pipelined, each one with a two byte
+// length prefix, and may be answered in any order. The connection stays
+// open for a while once idle, so later fallbacks skip the handshake.
+class DnsTcpSocket : public SessionSocket
+{
+public:
+    DnsTcpSocket(
+        Socket&& sock,
+        Resolver& resolver,
+        const IPAddress& nameserver
+    );
+
+    using SessionSocket::get_socket;
+    const IPAddress& get_nameserver() const;
+    Timer& get_idle_timer();
+
+    // non blocking, false if it failed right away
+    bool connect();
+    bool is_connected() const;
+    void set_connected();
+
+    // queued until sent by flush(), false if the queue is full
+    bool query(
+        uint16_t id,
         const std::string& domain_name,
-        uint16_t port,
-        sockspp::MemoryBuffer* buffer = nullptr
+        IPAddress::Version version
     );
 
-    const sockspp::Buffer& get_buffer() const;
+    bool has_pending_output() const;
+    bool flush(); // false on socket error
 
-    int query(const IPAddress& dns_address);
-    int get_response(std::vector<IPAddress>* addresses);
+    // reads what is available into the input buffer, > 0: bytes read,
+    // 0: closed by the nameserver, -1: socket error, EAGAIN included
+    int receive();
+
+    // next complete message of the input buffer
+    // > 0: decoded into `response`, 0: malformed, dropped, -1: none left
+    int get_response(DnsResponse* response);
 
     bool process_event(Event::Flags event_flags) override;
 
 private:
-    sockspp::Buffer _buffer;
-    std::string _domain_name;
-    uint16_t _port;
+    Resolver& _resolver;
+    IPAddress _nameserver;
+    bool _connected;
+    RingBuffer _output;
+    std::unique_ptr<uint8_t[]> _input; // length prefix + largest message
+    size_t _input_start;
+    size_t _input_size;
+    Timer _idle_timer;
+    Event::Flags _registered_events; // set by the resolver
 
+    friend class Resolver;
 
-}; // class DnsSocket
+}; // class DnsTcpSocket
 
 } // namespace sockspp::server
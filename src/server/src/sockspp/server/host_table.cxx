@@ -0,0 +1,199 @@
+#include "host_table.hpp"
+#include "utils.hpp"
+
+#include <sockspp/core/dns.hpp>
+#include <sockspp/core/log.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace sockspp::server
+{
+
+static inline char _to_lower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+std::shared_ptr<const HostTable> HostTable::load(
+    const std::vector<std::string>& paths
+) {
+    std::vector<std::pair<std::string, std::vector<IPAddress>>> hosts;
+    std::unordered_map<std::string, std::pair<size_t, size_t>> index; // file, host
+
+    for (size_t file_idx = 0; file_idx < paths.size(); file_idx++)
+    {
+        std::ifstream file(paths[file_idx]);
+
+        if (!file.is_open())
+            continue;
+
+        std::string line;
+
+        while (std::getline(file, line))
+        {
+            line = line.substr(0, line.find('#'));
+
+            std::vector<std::string> fields;
+            size_t start = line.find_first_not_of(" \t\r");
+
+            while (start != std::string::npos)
+            {
+                size_t end = line.find_first_of(" \t\r", start);
+                fields.push_back(line.substr(start, end - start));
+                start = line.find_first_not_of(" \t\r", end);
+            }
+
+            if (fields.size() < 2)
+                continue;
+
+            IPAddress address;
+
+            try {
+                address = IPAddress(fields[0], 0);
+            } catch (const std::runtime_error&) {
+                // e.g. scoped IPv6 addresses (fe80::1%lo0)
+                LOGD("HOSTS | %s: invalid address %s", paths[file_idx].c_str(), fields[0].c_str());
+                continue;
+            }
+
+            for (size_t i = 1; i < fields.size(); i++)
+            {
+                std::string name = normalize_domain_name(fields[i]);
+
+                if (name.empty() || name.size() > SOCKSPP_DNS_MAX_NAME_LENGTH)
+                    continue;
+
+                auto found = index.find(name);
+
+                if (found == index.end())
+                {
+                    index.emplace(name, std::make_pair(file_idx, hosts.size()));
+                    hosts.emplace_back(std::move(name), std::vector<IPAddress>{ address });
+                }
+                else if (found->second.first == file_idx)
+                {
+                    // the same name on several lines of a file adds up
+                    hosts[found->second.second].second.push_back(address);
+                }
+            }
+        }
+    }
+
+    std::shared_ptr<HostTable> table(new HostTable());
+    table->_build(hosts);
+    return table;
+}
+
+bool HostTable::lookup(
+    std::string_view name,
+    uint16_t port,
+    std::vector<IPAddress>& addresses
+) const {
+    if (!name.empty() && name.back() == '.')
+        name.remove_suffix(1);
+
+    if (!_size || name.empty())
+        return false;
+
+    uint64_t hash = _hash(name);
+    size_t mask = _slots.size() - 1;
+
+    for (size_t i = hash & mask; _slots[i].address_count; i = (i + 1) & mask)
+    {
+        const Slot& slot = _slots[i];
+
+        if (slot.hash != hash || slot.name_length != name.size())
+            continue;
+
+        const char* stored = _names.data() + slot.name_offset;
+        size_t j = 0;
+
+        while (j < name.size() && _to_lower(name[j]) == stored[j])
+        {
+            j++;
+        }
+
+        if (j != name.size())
+            continue;
+
+        for (size_t k = 0; k < slot.address_count; k++)
+        {
+            const IPAddress& address = _addresses[slot.address_offset + k];
+
+            addresses.emplace_back(
+                address.get_version(),
+                address.get_address(),
+                port
+            );
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+size_t HostTable::get_size() const
+{
+    return _size;
+}
+
+uint64_t HostTable::_hash(std::string_view name)
+{
+    // FNV-1a of the name in lower case
+    uint64_t hash = 0xCBF29CE484222325ull;
+
+    for (char c : name)
+    {
+        hash ^= static_cast<uint8_t>(_to_lower(c));
+        hash *= 0x100000001B3ull;
+    }
+
+    return hash;
+}
+
+void HostTable::_build(
+    const std::vector<std::pair<std::string, std::vector<IPAddress>>>& hosts
+) {
+    size_t capacity = 8;
+
+    while (capacity < hosts.size() * 2)
+    {
+        capacity <<= 1;
+    }
+
+    _slots.assign(capacity, Slot{ 0, 0, 0, 0, 0 });
+    _size = 0;
+
+    for (const auto& [name, addresses] : hosts)
+    {
+        uint64_t hash = _hash(name);
+        size_t i = hash & (capacity - 1);
+
+        while (_slots[i].address_count)
+        {
+            i = (i + 1) & (capacity - 1);
+        }
+
+        _slots[i] = Slot{
+            hash,
+            static_cast<uint32_t>(_names.size()),
+            static_cast<uint16_t>(name.size()),
+            static_cast<uint16_t>(std::min<size_t>(addresses.size(), UINT16_MAX)),
+            static_cast<uint32_t>(_addresses.size())
+        };
+
+        _names += name;
+        _addresses.insert(
+            _addresses.end(),
+            addresses.begin(),
+            addresses.begin() + _slots[i].address_count
+        );
+        _size++;
+    }
+}
+
+} // namespace sockspp::server
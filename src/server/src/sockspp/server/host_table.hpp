@@ -0,0 +1,65 @@
+#pragma once
+
+#include <sockspp/core/ip_address.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+namespace sockspp::server
+{
+
+// Static name -> addresses table in the hosts file format
+// ("address name [aliases...] # comment"). Built once and never modified,
+// so it is shared between workers without locking: the names are packed
+// in one string and found through an open addressing hash table.
+class HostTable
+{
+public:
+    HostTable(const HostTable& other) = delete;
+
+    // files in order of precedence, a name defined in one file hides
+    // the same name in the next ones, missing files are skipped
+    static std::shared_ptr<const HostTable> load(
+        const std::vector<std::string>& paths
+    );
+
+    // the addresses of the name are appended with the given port,
+    // the name is matched without case and without the trailing dot
+    bool lookup(
+        std::string_view name,
+        uint16_t port,
+        std::vector<IPAddress>& addresses
+    ) const;
+
+    size_t get_size() const;
+
+private:
+    struct Slot
+    {
+        uint64_t hash;
+        uint32_t name_offset;
+        uint16_t name_length;
+        uint16_t address_count;  // 0 = empty slot
+        uint32_t address_offset;
+    };
+
+    HostTable() = default;
+
+    static uint64_t _hash(std::string_view name);
+    void _build(
+        const std::vector<std::pair<std::string, std::vector<IPAddress>>>& hosts
+    );
+
+private:
+    std::string _names;
+    std::vector<IPAddress> _addresses;
+    std::vector<Slot> _slots; // power of two, at most half full
+    size_t _size = 0;
+
+}; // class HostTable
+
+} // namespace sockspp::server
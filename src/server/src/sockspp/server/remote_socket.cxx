@@ -24,28 +24,18 @@ namespace sockspp::server
 
 RemoteSocket::RemoteSocket(
     Socket&& sock,
-    const std::vector<IPAddress>* addresses
+    const IPAddress* address
 )   : SessionSocket(std::move(sock))
-    , _addresses(addresses)
-    , _connecting_idx(-1)
+    , _address(address)
     , _connected(false)
 {
     Socket& _sock = this->get_socket();
     _sock.set_blocking(false);
-
-    if (!addresses)
-        _connected = true;
-}
-
-RemoteSocket::~RemoteSocket()
-{
-    if (_addresses)
-        delete _addresses;
 }
 
 bool RemoteSocket::process_event(Event::Flags event_flags)
 {
-    return this->get_session().process_remote_event(event_flags);
+    return this->get_session().process_remote_event(event_flags, this);
 }
 
 bool RemoteSocket::is_connected() const
@@ -53,112 +43,79 @@ bool RemoteSocket::is_connected() const
     return _connected;
 }
 
-bool RemoteSocket::try_connect_next()
+bool RemoteSocket::connect()
 {
-    _connecting_idx++;
+    IPAddress::Version addr_ver = _address->get_version();
+    sockaddr_storage sock_addr;
 
-    if (_connecting_idx <= _addresses->size())
+    if (addr_ver == IPAddress::Version::IPv4)
     {
-        const IPAddress& addr = _addresses->at(
-            _connecting_idx == _addresses->size()
-            ? _connecting_idx-1
-            : _connecting_idx
-        );
-        IPAddress::Version addr_ver = addr.get_version();
-        sockaddr_storage sock_addr;
-
-        if (addr_ver == IPAddress::Version::IPv4)
-        {
-            sock_addr.ss_family = AF_INET;
-            sockaddr_in* _sock_addr = reinterpret_cast<sockaddr_in*>(&sock_addr);
-            _sock_addr->sin_addr.s_addr =
-                *reinterpret_cast<uint32_t*>(addr.get_address());
-            _sock_addr->sin_port = addr.get_netport();
-        }
-        else
-        {
-            sock_addr.ss_family = AF_INET6;
-            sockaddr_in6* _sock_addr = reinterpret_cast<sockaddr_in6*>(&sock_addr);
-            memcpy(
-                &_sock_addr->sin6_addr,
-                addr.get_address(),
-                16
-            );
-            _sock_addr->sin6_port = addr.get_netport();
-        }
-
-        if (_connecting_idx == _addresses->size())
-        {
-            this->get_session().reply_remote_connection(
-                Reply::Unreachable,
-                addr_ver == IPAddress::Version::IPv4
-                    ? AddrType::IPv4
-                    : AddrType::IPv6,
-                addr.get_address(),
-                addr.get_port()
-            );
-
-            LOGE("TCP | Couldn't connect");
-            return false;
-        }
-
-        LOG_SCOPE(LOG_LEVEL_DEBUG)
-        {
-            SocketInfo info;
-            info.from(&sock_addr);
-            LOGD("TCP | Attempting to connect to %s", info.str().c_str());
-        }
-
-        int res = this->get_socket().connect(
-            reinterpret_cast<sockaddr*>(&sock_addr),
-            addr_ver == IPAddress::Version::IPv4
-                ? sizeof(sockaddr_in)
-                : sizeof(sockaddr_in6)
+        sock_addr.ss_family = AF_INET;
+        sockaddr_in* _sock_addr = reinterpret_cast<sockaddr_in*>(&sock_addr);
+        _sock_addr->sin_addr.s_addr =
+            *reinterpret_cast<uint32_t*>(_address->get_address());
+        _sock_addr->sin_port = _address->get_netport();
+    }
+    else
+    {
+        sock_addr.ss_family = AF_INET6;
+        sockaddr_in6* _sock_addr = reinterpret_cast<sockaddr_in6*>(&sock_addr);
+        memset(_sock_addr, 0, sizeof(sockaddr_in6));
+        _sock_addr->sin6_family = AF_INET6;
+        memcpy(
+            &_sock_addr->sin6_addr,
+            _address->get_address(),
+            16
         );
+        _sock_addr->sin6_port = _address->get_netport();
+    }
+
+    LOG_SCOPE(LOG_LEVEL_DEBUG)
+    {
+        SocketInfo info;
+        info.from(&sock_addr);
+        LOGD("TCP | Attempting to connect to %s", info.str().c_str());
+    }
 
-        if (res < 0
-            && (sockerrno != SOCKSPP_EWOULDBLOCK)
-            && (sockerrno != SOCKSPP_EAGAIN)
-            && (sockerrno != SOCKSPP_EINPROGRESS))
-        {
-            LOGE("TCP | ::connect(...) == -1 (errno == %d)", sockerrno);
-            // TODO: Reply based on errno and fix reply address
-            this->get_session().reply_remote_connection(
-                Reply::GeneralFailure,
-                addr_ver == IPAddress::Version::IPv4
-                    ? AddrType::IPv4
-                    : AddrType::IPv6,
-                addr.get_address(),
-                addr.get_port()
-            );
-            return false;
-        }
-
-        return true;
+    int res = this->get_socket().connect(
+        reinterpret_cast<sockaddr*>(&sock_addr),
+        addr_ver == IPAddress::Version::IPv4
+            ? sizeof(sockaddr_in)
+            : sizeof(sockaddr_in6)
+    );
+
+    if (res < 0
+        && (sockerrno != SOCKSPP_EWOULDBLOCK)
+        && (sockerrno != SOCKSPP_EAGAIN)
+        && (sockerrno != SOCKSPP_EINPROGRESS))
+    {
+        LOGD("TCP | ::connect(...) == -1 (errno == %d)", sockerrno);
+        return false;
     }
 
-    return false;
+    return true;
 }
 
 bool RemoteSocket::could_connect()
 {
     _connected = true;
-    IPAddress connected_address = _addresses->at(_connecting_idx);
-    delete _addresses;
-    _addresses = nullptr;
-
     _remote_info = this->get_socket().get_peer_address();
 
     return this->get_session().reply_remote_connection(
         Reply::Success,
-        connected_address.get_version() == IPAddress::Version::IPv4
+        _address->get_version() == IPAddress::Version::IPv4
             ? AddrType::IPv4
             : AddrType::IPv6,
-        connected_address.get_address(),
-        connected_address.get_port()
+        _address->get_address(),
+        _address->get_port()
     );
 }
 
+const IPAddress* RemoteSocket::get_address() const
+{
+    return _address;
+}
+
 const SocketInfo& RemoteSocket::get_remote_info() const
 {
     return _remote_info;
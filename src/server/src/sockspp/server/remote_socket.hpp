@@ -13,27 +13,28 @@ namespace sockspp::server
 
 class Session;
 
-// You can call it a TCP socket
+// You can call it a TCP socket. Every socket connects to a single
+// address, a session may race several of them (Happy Eyeballs).
+// The address is owned by the session and must outlive the socket.
 class RemoteSocket : public SessionSocket
 {
 public:
     RemoteSocket(
         Socket&& sock,
-        const std::vector<IPAddress>* addresses
+        const IPAddress* address
     );
-    ~RemoteSocket();
 
     bool process_event(Event::Flags event_flags) override;
 
     bool is_connected() const;
-    bool try_connect_next();
+    bool connect(); // false if it failed right away (sockerrno)
     bool could_connect();
+    const IPAddress* get_address() const;
     const SocketInfo& get_remote_info() const;
 
 private:
     SocketInfo _remote_info;
-    const std::vector<IPAddress>* _addresses;
-    size_t _connecting_idx;
+    const IPAddress* _address;
     bool _connected;
 }; // class RemoteSocket
 
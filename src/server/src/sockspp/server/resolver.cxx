@@ -0,0 +1,840 @@
+#include "resolver.hpp"
+#include "server.hpp"
+#include "dns_socket.hpp"
+#include "utils.hpp"
+#include "defs.hpp"
+
+#include <sockspp/core/errno.hpp>
+#include <sockspp/core/exceptions.hpp>
+#include <sockspp/core/poller/event.hpp>
+#include <sockspp/core/log.hpp>
+
+#include <algorithm>
+#include <tuple>
+#include <string_view>
+
+namespace sockspp::server
+{
+
+static const char* _dns_rcodes[] = {
+    "No Error",
+    "Format Error",
+    "Server Failure",
+    "Name Error",
+    "Not Implemented",
+    "Refused"
+};
+
+DnsRequest::DnsRequest()
+    : _resolver(nullptr)
+    , _query(nullptr)
+    , _prev(nullptr)
+    , _next(nullptr) {}
+
+DnsRequest::DnsRequest(Callback&& callback)
+    : DnsRequest()
+{
+    _callback = std::move(callback);
+}
+
+DnsRequest::~DnsRequest()
+{
+    cancel();
+}
+
+bool DnsRequest::is_pending() const
+{
+    return _resolver != nullptr;
+}
+
+void DnsRequest::cancel()
+{
+    if (_resolver)
+        _resolver->cancel(*this);
+}
+
+Resolver::Resolver(
+    const Server& server,
+    Poller& poller,
+    TimerWheel& timers
+)   : _server(server)
+    , _poller(poller)
+    , _timers(timers)
+    , _random(std::random_device{}())
+{
+    _response.addresses = _addresses;
+    _response.address_capacity = SOCKSPP_RESOLVER_MAX_ADDRESSES;
+
+    // answers may be as large as the payload size advertised with EDNS0
+    _buffer.resize(std::max<size_t>(
+        server.get_dns_udp_payload_size(),
+        SOCKSPP_DNS_MAX_UDP_SIZE
+    ));
+
+    for (const IPAddress& address : server.get_nameservers())
+    {
+        DnsServer server;
+        server.address = address;
+        _servers.push_back(std::move(server));
+    }
+}
+
+Resolver::~Resolver()
+{
+    for (auto& [name, query] : _queries)
+    {
+        while (DnsRequest* request = query->requests)
+        {
+            cancel(*request);
+        }
+
+        _query_pool.destroy(query);
+    }
+
+    _queries.clear();
+    _ids.clear();
+
+    for (DnsServer& server : _servers)
+    {
+        if (server.socket)
+            _poller.remove_event(server.socket->get_socket().get_fd());
+
+        if (server.tcp_socket)
+            _poller.remove_event(server.tcp_socket->get_socket().get_fd());
+    }
+}
+
+bool Resolver::resolve(const std::string& name, DnsRequest& request)
+{
+    request.cancel();
+
+    std::string key = normalize_domain_name(name);
+    DnsQuery* query = nullptr;
+
+    auto found = _queries.find(key);
+
+    if (found != _queries.end())
+    {
+        // the same name is already being resolved, wait for that answer
+        // unless the resolution delay is over, the addresses known by
+        // then are answered right away (from the loop, not from here)
+        query = found->second;
+        LOGD("DNS QUERY | %s (pending)", key.c_str());
+
+        if (query->delayed)
+            _timers.arm(query->delay, 0);
+    }
+    else
+    {
+        query = _send_query(key);
+
+        if (!query)
+            return false;
+    }
+
+    request._resolver = this;
+    request._query = query;
+    request._prev = nullptr;
+    request._next = query->requests;
+
+    if (query->requests)
+        query->requests->_prev = &request;
+
+    query->requests = &request;
+    return true;
+}
+
+void Resolver::refresh(const std::string& name)
+{
+    std::string key = normalize_domain_name(name);
+
+    if (_queries.contains(key))
+        return;
+
+    if (_send_query(key))
+        LOGD("DNS QUERY | %s (refresh)", key.c_str());
+}
+
+void Resolver::cancel(DnsRequest& request)
+{
+    if (request._resolver != this)
+        return;
+
+    // the query itself goes on, its answer still fills the cache
+    if (request._prev)
+        request._prev->_next = request._next;
+    else
+        request._query->requests = request._next;
+
+    if (request._next)
+        request._next->_prev = request._prev;
+
+    request._resolver = nullptr;
+    request._query = nullptr;
+    request._prev = nullptr;
+    request._next = nullptr;
+}
+
+bool Resolver::process_event(DnsSocket* dns_socket, Event::Flags event_flags)
+{
+    size_t idx = 0;
+
+    while (idx < _servers.size() && _servers[idx].socket.get() != dns_socket)
+    {
+        idx++;
+    }
+
+    if (idx == _servers.size())
+        return false;
+
+    DnsServer& server = _servers[idx];
+
+    if (event_flags & Event::Error)
+    {
+        // e.g. ICMP unreachable, queries in flight get retransmitted
+        LOGW(
+            "DNS socket error (nameserver: %zu, errno: %d)",
+            idx,
+            dns_socket->get_socket().get_error()
+        );
+        _server_failed(server);
+    }
+
+    // several responses may be waiting on the socket
+    while (true)
+    {
+        int status = dns_socket->get_response(
+            _buffer.data(),
+            _buffer.size(),
+            &_response
+        );
+
+        if (status == -1)
+        {
+            if ((sockerrno != SOCKSPP_EWOULDBLOCK) && (sockerrno != SOCKSPP_EAGAIN))
+                LOGE("DNS Response receive error (errno: %d)", sockerrno);
+
+            break;
+        }
+        else if (status == 0)
+        {
+            continue;
+        }
+
+        _process_response(idx, false);
+    }
+
+    return true;
+}
+
+bool Resolver::process_event(DnsTcpSocket* tcp_socket, Event::Flags event_flags)
+{
+    size_t idx = 0;
+
+    while (idx < _servers.size() && _servers[idx].tcp_socket.get() != tcp_socket)
+    {
+        idx++;
+    }
+
+    // closed earlier in this batch
+    if (idx == _servers.size())
+        return false;
+
+    DnsServer& server = _servers[idx];
+
+    if (!tcp_socket->is_connected())
+    {
+        int error = tcp_socket->get_socket().get_error();
+
+        if (error || (event_flags & (Event::Error | Event::Closed)))
+        {
+            // queries sent this way get retransmitted over UDP,
+            // they make do with the truncated answers this time
+            LOGW(
+                "DNS TCP connection failed (nameserver: %zu, errno: %d)",
+                idx,
+                error
+            );
+            server.tcp_retry_time = _timers.get_time()
+                + SOCKSPP_RESOLVER_SERVER_HOLDDOWN;
+            _close_tcp_socket(server);
+            return true;
+        }
+
+        if (!(event_flags & Event::Write))
+            return true;
+
+        tcp_socket->set_connected();
+        LOGD("DNS TCP connection established (nameserver: %zu)", idx);
+    }
+
+    if (event_flags & Event::Error)
+    {
+        LOGW(
+            "DNS TCP connection error (nameserver: %zu, errno: %d)",
+            idx,
+            tcp_socket->get_socket().get_error()
+        );
+        _close_tcp_socket(server);
+        return true;
+    }
+
+    if ((event_flags & Event::Write) && !tcp_socket->flush())
+    {
+        LOGW("DNS TCP send error (nameserver: %zu, errno: %d)", idx, sockerrno);
+        _close_tcp_socket(server);
+        return true;
+    }
+
+    if (event_flags & (Event::Read | Event::Closed))
+    {
+        int size = tcp_socket->receive();
+
+        if (size == 0
+            || (size < 0
+                && (sockerrno != SOCKSPP_EWOULDBLOCK)
+                && (sockerrno != SOCKSPP_EAGAIN)))
+        {
+            // nameservers close idle connections too
+            LOGD("DNS TCP connection closed (nameserver: %zu)", idx);
+            _close_tcp_socket(server);
+            return true;
+        }
+
+        int status;
+
+        while ((status = tcp_socket->get_response(&_response)) != -1)
+        {
+            if (status > 0)
+                _process_response(idx, true);
+        }
+
+        _timers.arm(tcp_socket->get_idle_timer(), SOCKSPP_RESOLVER_TCP_IDLE_TIMEOUT);
+    }
+
+    _update_tcp_events(*tcp_socket);
+    return true;
+}
+
+size_t Resolver::get_query_count() const
+{
+    return _queries.size();
+}
+
+void Resolver::reclaim_sockets()
+{
+    _closed_sockets.clear();
+}
+
+void Resolver::_process_response(size_t idx, bool tcp)
+{
+    DnsServer& server = _servers[idx];
+    uint16_t id = _response.id;
+    auto found = _ids.find(id);
+
+    // names are compared in lower case without the trailing dot,
+    // the same as the keys of the queries
+    if (found == _ids.end()
+        || !(found->second->tried & (1u << idx))
+        || found->second->name != std::string_view(
+            _response.name,
+            _response.name_length))
+    {
+        // late answers to retransmitted queries end up here too
+        LOGD(
+            "DNS response doesn't match any query (id: %u, domain: %s), dropped",
+            id,
+            _response.name
+        );
+        return;
+    }
+
+    DnsQuery* query = found->second;
+    int family = (query->pending[0] && query->ids[0] == id) ? 0 : 1;
+
+    if (_response.type != (family ? DnsType::AAAA : DnsType::A))
+    {
+        LOGW("DNS response to another question type, dropped");
+        return;
+    }
+
+    // the round trip of a retransmitted query is ambiguous (Karn),
+    // the one over tcp includes the handshake
+    if (query->transmissions == 1 && !tcp)
+    {
+        uint64_t rtt = _timers.get_time() - query->sent_time;
+        server.rtt = static_cast<uint32_t>((server.rtt * 7ull + rtt) / 8);
+    }
+
+    // the answer didn't fit in the datagram, the same
+    // nameserver is asked again over tcp (RFC 7766)
+    if (_response.truncated && !tcp)
+    {
+        // already sent to another one, that answer counts
+        if (idx != query->server)
+            return;
+
+        if (_send_tcp(idx, query, family))
+            return;
+
+        // the addresses that fit are better than nothing
+    }
+
+    // server failure, not implemented, refused: another
+    // nameserver may do better, if there is one left
+    if (_response.rcode == DnsRCode::ServerFailure
+        || _response.rcode == DnsRCode::NotImplemented
+        || _response.rcode == DnsRCode::Refused)
+    {
+        LOGD(
+            "DNS QUERY | %s refused (rcode: %u)",
+            query->name.c_str(),
+            static_cast<unsigned int>(_response.rcode)
+        );
+        _server_failed(server);
+
+        if (idx != query->server)
+            return;
+
+        if (query->tried != (1u << _servers.size()) - 1)
+        {
+            _transmit(query);
+            return;
+        }
+    }
+    else
+    {
+        server.failures = 0;
+    }
+
+    uint32_t ttl = _response.answer_ttl;
+
+    if (!_response.address_count)
+    {
+        uint8_t rcode = static_cast<uint8_t>(_response.rcode);
+
+        LOGD(
+            "DNS QUERY no answer. Domain: %s, reason: \"%s\"",
+            _response.name,
+            rcode < 6 ? _dns_rcodes[rcode] : "Unknown"
+        );
+
+        // NXDOMAIN and no data answers are cacheable (RFC 2308),
+        // for as long as the SOA in the authority section allows
+        ttl = (_response.rcode == DnsRCode::NoError
+                || _response.rcode == DnsRCode::NameError)
+            ? _response.soa_ttl
+            : 0;
+    }
+
+    _ids.erase(id);
+    query->pending[family] = false;
+    query->ttl = std::min(query->ttl, ttl);
+    query->addresses.insert(
+        query->addresses.end(),
+        _addresses,
+        _addresses + _response.address_count
+    );
+
+    if (query->pending[0] || query->pending[1])
+    {
+        // addresses of the preferred family (AAAA) are worth
+        // a short wait, the other way around they are not
+        if (family == 0 && _response.address_count)
+        {
+            _timers.arm(query->delay, SOCKSPP_RESOLVER_RESOLUTION_DELAY);
+        }
+
+        return;
+    }
+
+    _cache_answer(query);
+    _finish_query(query);
+}
+
+bool Resolver::_open_socket(DnsServer& server)
+{
+    try {
+        Socket sock = server.address.get_version() == IPAddress::Version::IPv4
+            ? Socket::open_udp()
+            : Socket::open_udp6();
+
+        sock.set_blocking(false);
+
+        server.socket = std::make_unique<DnsSocket>(
+            std::move(sock),
+            *this,
+            server.address,
+            _server.get_dns_udp_payload_size()
+        );
+    } catch (const SocketCreationException& ex) {
+        LOGE("DNS socket couldn't be opened (errno: %d)", ex.code());
+        return false;
+    }
+
+    if (!_poller.register_event(Event(
+            server.socket->get_socket().get_fd(),
+            static_cast<Event::Flags>(Event::Read | Event::Closed),
+            reinterpret_cast<void*>(server.socket.get()))))
+    {
+        LOGE("DNS socket couldn't be registered (errno: %d)", sockerrno);
+        server.socket.reset();
+        return false;
+    }
+
+    return true;
+}
+
+bool Resolver::_open_tcp_socket(size_t idx)
+{
+    DnsServer& server = _servers[idx];
+
+    try {
+        Socket sock = server.address.get_version() == IPAddress::Version::IPv4
+            ? Socket::open_tcp()
+            : Socket::open_tcp6();
+
+        sock.set_blocking(false);
+
+        server.tcp_socket = std::make_unique<DnsTcpSocket>(
+            std::move(sock),
+            *this,
+            server.address
+        );
+    } catch (const SocketCreationException& ex) {
+        LOGE("DNS TCP socket couldn't be opened (errno: %d)", ex.code());
+        return false;
+    }
+
+    DnsTcpSocket& tcp_socket = *server.tcp_socket;
+    Event::Flags flags = static_cast<Event::Flags>(
+        Event::Read | Event::Write | Event::Closed
+    );
+
+    if (!tcp_socket.connect())
+    {
+        LOGW("DNS TCP connection failed (nameserver: %zu, errno: %d)", idx, sockerrno);
+        server.tcp_retry_time = _timers.get_time() + SOCKSPP_RESOLVER_SERVER_HOLDDOWN;
+        server.tcp_socket.reset();
+        return false;
+    }
+
+    if (!_poller.register_event(Event(
+            tcp_socket.get_socket().get_fd(),
+            flags,
+            reinterpret_cast<void*>(&tcp_socket))))
+    {
+        LOGE("DNS TCP socket couldn't be registered (errno: %d)", sockerrno);
+        server.tcp_socket.reset();
+        return false;
+    }
+
+    tcp_socket._registered_events = flags;
+    tcp_socket.get_idle_timer().set_callback([this, idx]() {
+        LOGD("DNS TCP connection idle, closed (nameserver: %zu)", idx);
+        _close_tcp_socket(_servers[idx]);
+    });
+
+    return true;
+}
+
+void Resolver::_close_tcp_socket(DnsServer& server)
+{
+    DnsTcpSocket* tcp_socket = server.tcp_socket.get();
+
+    // the socket itself may still have events in the current batch
+    _poller.remove_event(tcp_socket->get_socket().get_fd());
+    tcp_socket->get_idle_timer().cancel();
+    tcp_socket->get_socket().close();
+    _closed_sockets.push_back(std::move(server.tcp_socket));
+}
+
+void Resolver::_update_tcp_events(DnsTcpSocket& tcp_socket)
+{
+    uint32_t events = Event::Read | Event::Closed;
+
+    if (!tcp_socket.is_connected() || tcp_socket.has_pending_output())
+        events |= Event::Write;
+
+    Event::Flags flags = static_cast<Event::Flags>(events);
+
+    if (flags == tcp_socket._registered_events)
+        return;
+
+    if (_poller.update_event(Event(
+            tcp_socket.get_socket().get_fd(),
+            flags,
+            reinterpret_cast<void*>(&tcp_socket))))
+    {
+        tcp_socket._registered_events = flags;
+    }
+}
+
+bool Resolver::_send_tcp(size_t idx, DnsQuery* query, int family)
+{
+    DnsServer& server = _servers[idx];
+
+    if (!server.tcp_socket
+        && (server.tcp_retry_time > _timers.get_time() || !_open_tcp_socket(idx)))
+    {
+        return false;
+    }
+
+    DnsTcpSocket& tcp_socket = *server.tcp_socket;
+
+    IPAddress::Version version = family
+        ? IPAddress::Version::IPv6
+        : IPAddress::Version::IPv4;
+
+    if (!tcp_socket.query(query->ids[family], query->name, version))
+    {
+        LOGW("DNS TCP query couldn't be queued: %s", query->name.c_str());
+        return false;
+    }
+
+    if (tcp_socket.is_connected() && !tcp_socket.flush())
+    {
+        LOGW("DNS TCP send error (nameserver: %zu, errno: %d)", idx, sockerrno);
+        _close_tcp_socket(server);
+        return false;
+    }
+
+    _update_tcp_events(tcp_socket);
+    _timers.arm(tcp_socket.get_idle_timer(), SOCKSPP_RESOLVER_TCP_IDLE_TIMEOUT);
+
+    // a handshake and a larger answer take longer
+    // than a datagram, the retransmission waits for them
+    _timers.arm(
+        query->retry,
+        std::clamp<uint32_t>(
+            server.rtt * 4,
+            SOCKSPP_RESOLVER_MIN_RTO,
+            SOCKSPP_RESOLVER_MAX_RTO
+        )
+    );
+
+    LOGD("DNS QUERY | %s truncated, asking over TCP", query->name.c_str());
+    return true;
+}
+
+size_t Resolver::_select_server(uint32_t tried) const
+{
+    uint64_t time = _timers.get_time();
+
+    // nameservers not tried for the query yet, then the ones
+    // not failing lately, then the fastest, then the configured order
+    auto rank = [&](size_t idx) {
+        const DnsServer& server = _servers[idx];
+
+        return std::make_tuple(
+            (tried >> idx) & 1u,
+            server.failures >= SOCKSPP_RESOLVER_MAX_FAILURES
+                && server.retry_time > time,
+            server.rtt
+        );
+    };
+
+    size_t best = 0;
+
+    for (size_t idx = 1; idx < _servers.size(); idx++)
+    {
+        if (rank(idx) < rank(best))
+            best = idx;
+    }
+
+    return best;
+}
+
+void Resolver::_server_failed(DnsServer& server)
+{
+    server.failures++;
+
+    // a slow nameserver falls behind the others
+    server.rtt = std::clamp<uint32_t>(
+        server.rtt * 2,
+        SOCKSPP_RESOLVER_MIN_RTO,
+        SOCKSPP_RESOLVER_MAX_RTO
+    );
+
+    if (server.failures >= SOCKSPP_RESOLVER_MAX_FAILURES)
+        server.retry_time = _timers.get_time() + SOCKSPP_RESOLVER_SERVER_HOLDDOWN;
+}
+
+bool Resolver::_allocate_id(uint16_t* id)
+{
+    if (_ids.size() >= UINT16_MAX)
+        return false;
+
+    // random ids make spoofed responses hard to guess
+    do
+    {
+        *id = static_cast<uint16_t>(_random());
+    } while (_ids.contains(*id));
+
+    return true;
+}
+
+DnsQuery* Resolver::_send_query(const std::string& name)
+{
+    if (_servers.empty())
+    {
+        return nullptr;
+    }
+
+    DnsQuery* query = _query_pool.create();
+    query->name = name;
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (!_allocate_id(&query->ids[i]))
+        {
+            LOGE("DNS Query error: too many queries");
+            break;
+        }
+
+        query->pending[i] = true;
+        _ids.emplace(query->ids[i], query);
+    }
+
+    if (!query->pending[0] || !query->pending[1] || !_transmit(query))
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            if (query->pending[i])
+                _ids.erase(query->ids[i]);
+        }
+
+        _query_pool.destroy(query);
+        return nullptr;
+    }
+
+    unsigned int timeout = _server.get_dns_timeout();
+
+    query->timer.set_callback([this, query]() {
+        LOGW("DNS QUERY timeout. Domain: %s", query->name.c_str());
+
+        // one of the families answered, that's what the name has
+        if (!query->addresses.empty())
+            _cache_answer(query);
+
+        _finish_query(query);
+    });
+
+    query->retry.set_callback([this, query]() {
+        _server_failed(_servers[query->server]);
+        _transmit(query);
+    });
+
+    query->delay.set_callback([this, query]() {
+        query->delayed = true;
+        _notify_requests(query);
+    });
+
+    _timers.arm(
+        query->timer,
+        timeout ? timeout * 1000ull : SOCKSPP_RESOLVER_QUERY_TIMEOUT
+    );
+
+    _queries.emplace(name, query);
+    return query;
+}
+
+bool Resolver::_transmit(DnsQuery* query)
+{
+    // every nameserver gets one chance at most
+    for (size_t i = 0; i < _servers.size(); i++)
+    {
+        size_t idx = _select_server(query->tried);
+        DnsServer& server = _servers[idx];
+        bool sent = server.socket || _open_socket(server);
+
+        query->tried |= 1u << idx;
+
+        for (int family = 0; sent && family < 2; family++)
+        {
+            if (!query->pending[family])
+                continue;
+
+            IPAddress::Version version = family
+                ? IPAddress::Version::IPv6
+                : IPAddress::Version::IPv4;
+
+            if (server.socket->query(query->ids[family], query->name, version) <= 0)
+            {
+                LOGE("DNS Query error (errno: %d)", sockerrno);
+                sent = false;
+            }
+        }
+
+        if (!sent)
+        {
+            _server_failed(server);
+            continue;
+        }
+
+        // exponential backoff from twice the round trip time
+        uint64_t rto = std::clamp<uint32_t>(
+            server.rtt * 2,
+            SOCKSPP_RESOLVER_MIN_RTO,
+            SOCKSPP_RESOLVER_MAX_RTO
+        );
+        rto = std::min<uint64_t>(
+            rto << std::min(query->transmissions, 4u),
+            SOCKSPP_RESOLVER_MAX_RTO
+        );
+
+        query->server = idx;
+        query->sent_time = _timers.get_time();
+        query->transmissions++;
+        _timers.arm(query->retry, rto);
+        return true;
+    }
+
+    return false;
+}
+
+void Resolver::_notify_requests(DnsQuery* query)
+{
+    // callbacks may close sessions and cancel other requests
+    // of this query, so they are detached one at a time
+    while (DnsRequest* request = query->requests)
+    {
+        cancel(*request);
+        request->_callback(query->addresses);
+    }
+}
+
+void Resolver::_cache_answer(DnsQuery* query)
+{
+    DnsCache* dns_cache = _server.get_dns_cache();
+
+    if (!dns_cache)
+        return;
+
+    dns_cache->insert(
+        query->name,
+        query->addresses,
+        query->ttl,
+        _timers.get_time()
+    );
+}
+
+void Resolver::_finish_query(DnsQuery* query)
+{
+    _queries.erase(query->name);
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (query->pending[i])
+            _ids.erase(query->ids[i]);
+    }
+
+    query->timer.cancel();
+    query->retry.cancel();
+    query->delay.cancel();
+
+    _notify_requests(query);
+    _query_pool.destroy(query);
+}
+
+} // namespace sockspp::server
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "defs.hpp"
+
+#include <sockspp/core/ip_address.hpp>
+#include <sockspp/core/dns.hpp>
+#include <sockspp/core/object_pool.hpp>
+#include <sockspp/core/timer_wheel.hpp>
+#include <sockspp/core/poller/poller.hpp>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <random>
+#include <functional>
+#include <unordered_map>
+
+namespace sockspp::server
+{
+
+class Server;
+class DnsSocket;
+class DnsTcpSocket;
+class Resolver;
+struct DnsQuery;
+
+// A pending name resolution of a session (intrusive node).
+// The callback gets the addresses without a port, or nothing
+// if the name couldn't be resolved. Detached when destroyed.
+class DnsRequest
+{
+public:
+    using Callback = std::function<void(const std::vector<IPAddress>&)>;
+
+    DnsRequest();
+    DnsRequest(Callback&& callback);
+    DnsRequest(const DnsRequest& other) = delete;
+    ~DnsRequest();
+
+    bool is_pending() const;
+    void cancel();
+
+private:
+    Callback _callback;
+    Resolver* _resolver;
+    DnsQuery* _query;
+    DnsRequest* _prev;
+    DnsRequest* _next;
+
+    friend class Resolver;
+}; // class DnsRequest
+
+// Outstanding query of a resolver, A and AAAA are asked in parallel
+struct DnsQuery
+{
+    std::string name;
+    uint16_t ids[2] = { 0, 0 };          // transaction ids (A, AAAA)
+    bool pending[2] = { false, false };
+    std::vector<IPAddress> addresses;    // answers received so far
+    uint32_t ttl = UINT32_MAX;
+    DnsRequest* requests = nullptr; // waiting for the answer
+    size_t server = 0;       // nameserver of the last transmission
+    uint32_t tried = 0;      // nameservers sent to (bit mask)
+    unsigned int transmissions = 0;
+    uint64_t sent_time = 0;  // of the last transmission
+    Timer timer; // gives up on the query
+    Timer retry; // retransmission, to the next nameserver if possible
+    Timer delay; // waiting for AAAA once A is there (RFC 8305)
+    bool delayed = false; // the delay is over, addresses so far are the answer
+}; // struct DnsQuery
+
+// A nameserver as seen by one resolver
+struct DnsServer
+{
+    IPAddress address;
+    std::unique_ptr<DnsSocket> socket; // opened on first use
+    std::unique_ptr<DnsTcpSocket> tcp_socket; // for truncated answers
+    uint32_t rtt = SOCKSPP_RESOLVER_INITIAL_RTT; // smoothed (ms)
+    unsigned int failures = 0; // unanswered queries in a row
+    uint64_t retry_time = 0;   // skipped until then after too many failures
+    uint64_t tcp_retry_time = 0; // no tcp until then after a failed connection
+}; // struct DnsServer
+
+// Per worker DNS resolver. Queries go through one UDP socket per
+// nameserver and replies are matched by a random transaction id and the
+// question. A and AAAA are queried in parallel, requests are answered
+// when both are there, or a short resolution delay after a positive A
+// answer. Unanswered queries are retransmitted with exponential backoff,
+// to another nameserver when there is one. Nameservers are preferred by
+// their smoothed round trip time, the ones failing repeatedly are skipped
+// for a while. Queries advertise a larger UDP payload with EDNS0, the
+// ones answered with the truncation bit set anyway are asked again over
+// a TCP connection to the same nameserver, kept open for a while.
+// Concurrent requests for the same name are attached to one outstanding
+// query and all of them are answered when it completes, answers are
+// also stored in the shared cache.
+class Resolver
+{
+public:
+    Resolver(
+        const Server& server,
+        Poller& poller,
+        TimerWheel& timers
+    );
+    Resolver(const Resolver& other) = delete;
+    ~Resolver();
+
+    // false if the query couldn't be sent, the callback is never
+    // called from here, only when the answer arrives or the query fails
+    bool resolve(const std::string& name, DnsRequest& request);
+    void cancel(DnsRequest& request);
+
+    // resolves the name again only to update the cache, nothing waits
+    // for it (a query for the name already in progress does the same)
+    void refresh(const std::string& name);
+
+    bool process_event(DnsSocket* dns_socket, Event::Flags event_flags);
+    bool process_event(DnsTcpSocket* tcp_socket, Event::Flags event_flags);
+    size_t get_query_count() const;
+
+    // frees the tcp sockets closed during the last batch of events
+    void reclaim_sockets();
+
+private:
+    bool _open_socket(DnsServer& server);
+    bool _open_tcp_socket(size_t idx);
+    void _close_tcp_socket(DnsServer& server);
+    void _update_tcp_events(DnsTcpSocket& tcp_socket);
+    bool _send_tcp(size_t idx, DnsQuery* query, int family);
+    void _process_response(size_t idx, bool tcp);
+    size_t _select_server(uint32_t tried) const;
+    void _server_failed(DnsServer& server);
+    bool _allocate_id(uint16_t* id);
+    DnsQuery* _send_query(const std::string& name);
+    bool _transmit(DnsQuery* query);
+    void _notify_requests(DnsQuery* query);
+    void _cache_answer(DnsQuery* query);
+    void _finish_query(DnsQuery* query);
+
+private:
+    const Server& _server;
+    Poller& _poller;
+    TimerWheel& _timers;
+    std::vector<DnsServer> _servers;
+    std::mt19937 _random;
+    ObjectPool<DnsQuery> _query_pool;
+    std::unordered_map<std::string, DnsQuery*> _queries;
+    std::unordered_map<uint16_t, DnsQuery*> _ids;
+    std::vector<std::unique_ptr<DnsTcpSocket>> _closed_sockets;
+
+    // response being processed
+    std::vector<uint8_t> _buffer; // datagram
+    DnsResponse _response;
+    IPAddress _addresses[SOCKSPP_RESOLVER_MAX_ADDRESSES];
+
+}; // class Resolver
+
+} // namespace sockspp::server
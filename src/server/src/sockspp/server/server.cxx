@@ -1,25 +1,22 @@
 #include "server.hpp"
-#include "session.hpp"
-#include "session_socket.hpp"
+#include "worker.hpp"
 #include "utils.hpp"
 #include "defs.hpp"
 
 #include <cctype>
 #include <sockspp/core/s5_enums.hpp>
-#include <sockspp/core/poller/poller.hpp>
-#include <sockspp/core/poller/event.hpp>
 #include <sockspp/core/utils.hpp>
+#include <sockspp/core/dns.hpp>
 #include <sockspp/core/log.hpp>
+#include <sockspp/core/exceptions.hpp>
 
+#include <cerrno>
+#include <climits>
 #include <vector>
+#include <thread>
+#include <functional>
 #include <algorithm>
 
-#if defined(_WIN32)
-    #define SOCKSPP_POLL_TIMEOUT 2000
-#else
-    #define SOCKSPP_POLL_TIMEOUT -1
-#endif // _WIN32
-
 namespace sockspp::server
 {
 
@@ -42,15 +39,16 @@ Server::Server(const ServerParams&& params)
         );
     }
 
+    std::vector<std::string> nameservers;
+
     if (_params.dns_ip == "none")
     {
         LOGI("DNS server: None");
-        LOGW("Domain name resolution is disabled");
         _params.dns_ip.clear();
     }
     else if (_params.dns_ip == "auto")
     {
-        auto nameservers = sockspp::server::get_dns_nameservers();
+        nameservers = sockspp::server::get_dns_nameservers();
 
         if (nameservers.empty())
         {
@@ -58,26 +56,182 @@ Server::Server(const ServerParams&& params)
                 "Couldn't get OS dns server address,"
                 "dns resolution will be disabled"
             );
-            _params.dns_ip.clear();
+        }
+    }
+    else
+    {
+        // comma separated list, in order of preference
+        size_t start = 0;
+
+        while (start <= _params.dns_ip.size())
+        {
+            size_t end = _params.dns_ip.find(',', start);
+
+            if (end == std::string::npos)
+                end = _params.dns_ip.size();
+
+            if (end > start)
+                nameservers.push_back(_params.dns_ip.substr(start, end - start));
+
+            start = end + 1;
+        }
+    }
+
+    for (const std::string& nameserver : nameservers)
+    {
+        if (!sockspp::is_ip_address(nameserver))
+        {
+            LOGE("Invalid DNS server address: %s", nameserver.c_str());
+        }
+        else if (_nameservers.size() >= SOCKSPP_RESOLVER_MAX_NAMESERVERS)
+        {
+            LOGW("Too many DNS servers, %s is not used", nameserver.c_str());
         }
         else
         {
-            LOGI("DNS server: Auto (%s)", nameservers[0].c_str());
-            _params.dns_ip = nameservers[0];
+            LOGI(
+                "DNS server: %s%s",
+                nameserver.c_str(),
+                _params.dns_ip == "auto" ? " (Auto)" : ""
+            );
+            _nameservers.emplace_back(nameserver, _params.dns_port);
         }
     }
-    else if (!sockspp::is_ip_address(_params.dns_ip))
+
+    if (_nameservers.empty())
     {
-        LOGE("Invalid DNS server address: %s", _params.dns_ip.c_str());
         LOGW("Domain name resolution is disabled");
         _params.dns_ip.clear();
     }
-    else
+    else if (_params.dns_cache_size)
+    {
+        _dns_cache = std::make_unique<DnsCache>(
+            _params.dns_cache_size,
+            _params.dns_negative_ttl,
+            _params.dns_refresh_hits,
+            _params.dns_refresh_rate
+        );
+
+        // a warm start: the names of the previous run, TTLs aged
+        if (!_params.dns_cache_file.empty())
+        {
+            size_t loaded = _dns_cache->load(
+                _params.dns_cache_file,
+                TimerWheel::now()
+            );
+
+            LOGI(
+                "DNS cache: %zu names loaded from %s",
+                loaded,
+                _params.dns_cache_file.c_str()
+            );
+        }
+    }
+
+    // static names, the user's file first so it can override the system
+    if (!_params.hosts_file.empty())
+    {
+        _hosts_paths.push_back(_params.hosts_file);
+    }
+
+    if (_params.system_hosts)
+    {
+        _hosts_paths.push_back(SOCKSPP_SYSTEM_HOSTS_FILE);
+    }
+
+    _hosts_version = 0;
+    this->reload_hosts(true);
+
+    // nothing to save periodically
+    if (!_dns_cache || _params.dns_cache_file.empty())
+    {
+        _params.dns_cache_save_interval = 0;
+    }
+
+    // RFC 6891: less than the classic limit means the classic limit
+    if (_params.dns_udp_payload_size
+        && _params.dns_udp_payload_size < SOCKSPP_DNS_MAX_UDP_SIZE)
+    {
+        _params.dns_udp_payload_size = SOCKSPP_DNS_MAX_UDP_SIZE;
+    }
+
+    // the scheduled buffer has to take whatever one recv() returned
+    if (_params.relay_buffer_size < SOCKSPP_SESSION_SOCKET_BUFFER_SIZE)
+    {
+        LOGW(
+            "Relay buffer size is too small, using %d",
+            SOCKSPP_SESSION_SOCKET_BUFFER_SIZE
+        );
+        _params.relay_buffer_size = SOCKSPP_SESSION_SOCKET_BUFFER_SIZE;
+    }
+
+    if (!_params.relay_high_watermark
+        || _params.relay_high_watermark > _params.relay_buffer_size)
+    {
+        _params.relay_high_watermark = _params.relay_buffer_size;
+    }
+
+    if (_params.relay_low_watermark >= _params.relay_high_watermark)
+    {
+        _params.relay_low_watermark = _params.relay_high_watermark / 2;
+    }
+
+    if (_params.accept_batch_size < 1)
+    {
+        _params.accept_batch_size = 1;
+        LOGW("Accept batch size is out of range, using %zu", _params.accept_batch_size);
+    }
+
+    if (_params.listen_backlog > INT_MAX)
+    {
+        _params.listen_backlog = INT_MAX;
+    }
+
+    if (_params.udp_batch_size < 1 || _params.udp_batch_size > SOCKSPP_SESSION_UDP_MAX_BATCH)
+    {
+        _params.udp_batch_size = std::clamp<size_t>(
+            _params.udp_batch_size,
+            1,
+            SOCKSPP_SESSION_UDP_MAX_BATCH
+        );
+        LOGW("UDP batch size is out of range, using %zu", _params.udp_batch_size);
+    }
+
+    // egress sockets are numbered with one byte
+    if (_params.udp_egress_sockets < 1 || _params.udp_egress_sockets > 256)
+    {
+        _params.udp_egress_sockets = std::clamp<size_t>(_params.udp_egress_sockets, 1, 256);
+        LOGW("UDP egress socket count is out of range, using %zu", _params.udp_egress_sockets);
+    }
+
+    if (!_params.udp_flow_limit)
+    {
+        _params.udp_flow_limit = 1;
+        LOGW("UDP flow limit can't be 0, using 1");
+    }
+
+    unsigned int workers = _params.workers;
+
+    if (!workers)
+    {
+        workers = std::thread::hardware_concurrency();
+        workers = workers ? workers : 1;
+    }
+
+    // the session limit is split evenly between workers
+    size_t worker_max_sessions = \
+        (_params.max_sessions + workers - 1) / workers;
+
+    _workers.reserve(workers);
+
+    for (unsigned int i = 0; i < workers; i++)
     {
-        LOGI("DNS server: %s", _params.dns_ip.c_str());
+        _workers.push_back(
+            std::make_unique<Worker>(*this, i, worker_max_sessions)
+        );
     }
 
-    _sessions.reserve(128);
+    _serving = false;
     _hook = std::make_unique<ServerHook>();
 }
 
@@ -101,6 +255,21 @@ uint16_t Server::get_listen_port() const
     return _params.listen_port;
 }
 
+unsigned int Server::get_listen_backlog() const
+{
+    return _params.listen_backlog;
+}
+
+size_t Server::get_accept_batch_size() const
+{
+    return _params.accept_batch_size;
+}
+
+unsigned int Server::get_tcp_defer_accept() const
+{
+    return _params.tcp_defer_accept;
+}
+
 AuthMethod Server::get_auth_method() const
 {
     if (_params.username.empty() && _params.password.empty())
@@ -121,6 +290,26 @@ uint16_t Server::get_dns_port() const
     return _params.dns_port;
 }
 
+const std::vector<IPAddress>& Server::get_nameservers() const
+{
+    return _nameservers;
+}
+
+DnsCache* Server::get_dns_cache() const
+{
+    return _dns_cache.get();
+}
+
+unsigned int Server::get_dns_cache_save_interval() const
+{
+    return _params.dns_cache_save_interval;
+}
+
+uint16_t Server::get_dns_udp_payload_size() const
+{
+    return _params.dns_udp_payload_size;
+}
+
 bool Server::get_client_tcp_nodelay() const
 {
     return _params.client_tcp_nodelay;
@@ -141,6 +330,161 @@ bool Server::get_remote_tcp_keepalive() const
     return _params.remote_tcp_keepalive;
 }
 
+bool Server::get_splice_relay() const
+{
+    return _params.splice_relay;
+}
+
+size_t Server::get_relay_buffer_size() const
+{
+    return _params.relay_buffer_size;
+}
+
+size_t Server::get_relay_high_watermark() const
+{
+    return _params.relay_high_watermark;
+}
+
+size_t Server::get_relay_low_watermark() const
+{
+    return _params.relay_low_watermark;
+}
+
+size_t Server::get_udp_batch_size() const
+{
+    return _params.udp_batch_size;
+}
+
+bool Server::get_udp_offload() const
+{
+    return _params.udp_offload;
+}
+
+bool Server::get_udp_shared_port() const
+{
+    return _params.udp_shared_port;
+}
+
+size_t Server::get_udp_egress_sockets() const
+{
+    return _params.udp_egress_sockets;
+}
+
+size_t Server::get_udp_flow_limit() const
+{
+    return _params.udp_flow_limit;
+}
+
+size_t Server::get_udp_reassembly_size() const
+{
+    return _params.udp_reassembly_size;
+}
+
+size_t Server::get_max_sessions() const
+{
+    return _params.max_sessions;
+}
+
+unsigned int Server::get_handshake_timeout() const
+{
+    return _params.handshake_timeout;
+}
+
+unsigned int Server::get_auth_timeout() const
+{
+    return _params.auth_timeout;
+}
+
+unsigned int Server::get_dns_timeout() const
+{
+    return _params.dns_timeout;
+}
+
+unsigned int Server::get_connect_timeout() const
+{
+    return _params.connect_timeout;
+}
+
+unsigned int Server::get_idle_timeout() const
+{
+    return _params.idle_timeout;
+}
+
+unsigned int Server::get_udp_flow_timeout() const
+{
+    return _params.udp_flow_timeout;
+}
+
+unsigned int Server::get_connect_attempt_delay() const
+{
+    return _params.connect_attempt_delay;
+}
+
+std::shared_ptr<const HostTable> Server::get_hosts() const
+{
+    std::lock_guard<std::mutex> lock(_hosts_mutex);
+    return _hosts;
+}
+
+uint64_t Server::get_hosts_version() const
+{
+    return _hosts_version.load(std::memory_order_acquire);
+}
+
+bool Server::has_hosts_files() const
+{
+    return !_hosts_paths.empty();
+}
+
+void Server::reload_hosts(bool force)
+{
+    std::vector<std::filesystem::file_time_type> mtimes;
+    mtimes.reserve(_hosts_paths.size());
+
+    for (const std::string& path : _hosts_paths)
+    {
+        std::error_code error;
+        auto mtime = std::filesystem::last_write_time(path, error);
+
+        mtimes.push_back(error ? std::filesystem::file_time_type::min() : mtime);
+    }
+
+    if (!force && mtimes == _hosts_mtimes)
+        return;
+
+    // built outside of the lock, lookups keep using the old table
+    std::shared_ptr<const HostTable> hosts = HostTable::load(_hosts_paths);
+
+    LOGI("Hosts: %zu names", hosts->get_size());
+
+    {
+        std::lock_guard<std::mutex> lock(_hosts_mutex);
+        _hosts = std::move(hosts);
+    }
+
+    _hosts_mtimes = std::move(mtimes);
+    _hosts_version.fetch_add(1, std::memory_order_release);
+}
+
+void Server::save_dns_cache() const
+{
+    if (!_dns_cache || _params.dns_cache_file.empty())
+        return;
+
+    if (_dns_cache->save(_params.dns_cache_file, TimerWheel::now()))
+    {
+        LOGD("DNS cache saved to %s", _params.dns_cache_file.c_str());
+    }
+    else
+    {
+        LOGW(
+            "DNS cache couldn't be saved to %s (errno: %d)",
+            _params.dns_cache_file.c_str(),
+            errno
+        );
+    }
+}
+
 bool Server::authenticate(
     const std::string& username,
     const std::string& password
@@ -154,220 +498,91 @@ bool Server::authenticate(
 
 void Server::serve()
 {
-    _server_socket = Socket::open_tcp();
-    _server_socket.set_blocking(false);
-    _server_socket.bind(_params.listen_ip, _params.listen_port);
-    LOGI("SOCKS5 serving on %s:%d", _params.listen_ip.c_str(), (int)_params.listen_port);
-    _server_socket.listen(SOCKSPP_SERVER_LISTEN);
-
-    Poller poller;
-    int server_sock = _server_socket.get_fd();
-    
-    {
-        Event server_event(
-            server_sock,
-            Event::Read,
-            reinterpret_cast<void*>(this)
-        );
+    bool reuse_port = _workers.size() > 1;
+    _serving = true;
 
-        if (!poller.register_event(server_event))
+    try {
+        for (auto& worker : _workers)
         {
-            LOGE("Couldn't register server event");
-            this->stop();
-            return;
+            worker->listen(reuse_port);
         }
+    } catch (...) {
+        this->stop();
+        throw;
     }
 
-    std::vector<Event> events;
-    events.reserve(SOCKSPP_SERVER_INITIAL_POLL_RESULT_SIZE);
+    LOGI(
+        "SOCKS5 serving on %s:%d (workers: %zu)",
+        _params.listen_ip.c_str(),
+        (int)_params.listen_port,
+        _workers.size()
+    );
 
     _hook->on_server_started(*this);
-    while (this->is_serving())
-    {
-        events.clear();
 
-        // workaround for Windows because it does not trigger EINTR
-        // that's why setting timeout to -1 is not preferred there
-        int res = poller.poll(events, SOCKSPP_POLL_TIMEOUT);
+    // the first worker runs in the calling thread
+    std::vector<std::thread> threads;
+    threads.reserve(_workers.size() - 1);
 
-        if (res == -1)
-        {
-            if (sockerrno != EINTR)
-            {
-                LOGE("Poll error: %d", sockerrno);
-                this->stop();
-            }
-            break;
-        }
-
-        if (!res)
-        {
-#if !defined(_WIN32)
-            LOGD("Poller timeout");
-#endif
-            continue;
-        }
+    for (size_t i = 1; i < _workers.size(); i++)
+    {
+        threads.emplace_back(&Server::_run_worker, this, std::ref(*_workers[i]));
+    }
 
-        for (int i = 0; i < events.size(); i++)
-        {
-            Event& event = events[i];
-            Event::Flags flags = event.get_flags();
-
-            // server 
-            if (event.get_ptr() == reinterpret_cast<void*>(this))
-            {
-                if (flags & Event::Read)
-                {
-                    Socket client = _accept_client();
-                    _create_new_session(poller, std::move(client));
-                }
-                else
-                {
-                    LOGE("Server error");
-                    this->stop();
-                    break;
-                }
-            }
+    _run_worker(*_workers[0]);
 
-            // session
-            else if (event.get_ptr())
-            {
-                SessionSocket* session_socket = \
-                    reinterpret_cast<SessionSocket*>(event.get_ptr());
-
-                if (!session_socket->process_event(flags))
-                {
-                    // delete session when socket is closed
-                    Session* session = &session_socket->get_session();
-
-                    // invalidate all next events associated
-                    // with the deleted session if there are any
-                    for (int j = i; j < events.size(); j++)
-                    {
-                        Event& event2 = events[j];
-                        if (event2.get_ptr() && event2.get_ptr() != this)
-                        {
-                            SessionSocket* session_socket2 = \
-                                reinterpret_cast<SessionSocket*>(event2.get_ptr());
-
-                            if (session == &session_socket2->get_session())
-                            {
-                                events[j] = Event(0, Event::Closed, nullptr);
-                            }
-                        }
-                    }
-
-                    _delete_session(session);
-
-                    // Print active sessions
-                    LOG_SCOPE(LOG_LEVEL_DEBUG)
-                    {
-                        int udp = 0;
-                        int tcp = 0;
-                        int dns = 0;
-                        int conn = 0;
-                        int other = 0;
-
-                        for (auto session : _sessions)
-                        {
-                            Session::State state = session->get_state();
-
-                            switch (state)
-                            {
-                                case Session::State::Associated:
-                                    udp++;
-                                    break;
-                                case Session::State::Connected:
-                                    tcp++;
-                                    break;
-                                case Session::State::ResolvingDomainName:
-                                    dns++;
-                                    break;
-                                case Session::State::ConnectingRemote:
-                                    conn++;
-                                    break;
-                                default:
-                                    other++;
-                                    break;
-                            }
-                        }
-
-                        LOGD(
-                            "Session count: %zu (udp: %d, tcp: %d, dns: %d, con: "
-                            "%d, other: %d)",
-                            _sessions.size(),
-                            udp, tcp, dns, conn, other
-                        );
-                    }
-                }
-            }
-        }
+    for (auto& thread : threads)
+    {
+        thread.join();
     }
 
+    for (auto& worker : _workers)
     {
-        Event server_event(
-            server_sock,
-            Event::Closed,
-            nullptr
-        );
-
-        poller.remove_event(server_event);
+        worker->close();
     }
 
-    _delete_all_sessions();
-
     if (this->is_serving())
     {
         this->stop();
     }
 
+    this->save_dns_cache();
     _hook->on_server_stopped(*this);
 }
 
-void Server::stop()
-{
-    _server_socket.shutdown();
-    _server_socket.close();
-}
-
-bool Server::is_serving() const
+void Server::_run_worker(Worker& worker)
 {
-    return _server_socket.get_fd() != -1;
+    // an exception leaving a thread would terminate the process,
+    // the other workers are stopped instead
+    try {
+        worker.run();
+    } catch (const Exception& ex) {
+        LOGE("Worker %d: %s", worker.get_id(), ex.full_message().c_str());
+        this->stop();
+    } catch (const std::exception& ex) {
+        LOGE("Worker %d: %s", worker.get_id(), ex.what());
+        this->stop();
+    }
 }
 
-Socket Server::_accept_client()
+void Server::stop()
 {
-    Socket client = _hook->client_accept(_server_socket);
-    return client;
-}
+    _serving = false;
 
-Session* Server::_create_new_session(Poller& poller, Socket&& sock)
-{
-    Session* session = new Session(*this, poller, std::move(sock));
-    session->initialize();
-    _sessions.push_back(session);
-    return session;
+    for (auto& worker : _workers)
+    {
+        worker->stop();
+    }
 }
 
-void Server::_delete_session(Session* session)
+bool Server::is_serving() const
 {
-    session->shutdown();
-    _sessions.erase(std::find(
-        _sessions.begin(),
-        _sessions.end(),
-        session
-    ));
-    delete session;
+    return _serving;
 }
 
-void Server::_delete_all_sessions()
+unsigned int Server::get_workers() const
 {
-    for (auto session : _sessions)
-    {
-        delete session;
-    }
-
-    _sessions.clear();
+    return _workers.size();
 }
 
 } // namespace sockspp::server
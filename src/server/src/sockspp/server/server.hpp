@@ -2,7 +2,9 @@
 
 #include "server_params.hpp"
 #include "server_hook.hpp"
-#include "session.hpp"
+#include "worker.hpp"
+#include "dns_cache.hpp"
+#include "host_table.hpp"
 
 #include <sockspp/core/s5_enums.hpp>
 #include <sockspp/core/socket.hpp>
@@ -11,6 +13,9 @@
 
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <filesystem>
 
 namespace sockspp::server
 {
@@ -24,19 +29,57 @@ public:
     void serve();
     void stop();
     bool is_serving() const;
+    unsigned int get_workers() const;
 
     void set_hook(std::unique_ptr<ServerHook>&& hook);
     const std::unique_ptr<ServerHook>& get_hook() const;
 
     const std::string& get_listen_ip() const;
     uint16_t get_listen_port() const;
+    unsigned int get_listen_backlog() const;
+    size_t get_accept_batch_size() const;
+    unsigned int get_tcp_defer_accept() const;
     AuthMethod get_auth_method() const;
     const std::string& get_dns_ip() const;
     uint16_t get_dns_port() const;
+    const std::vector<IPAddress>& get_nameservers() const; // empty = no dns
+    DnsCache* get_dns_cache() const; // nullptr if disabled
+    unsigned int get_dns_cache_save_interval() const;
+
+    // the current host table (never nullptr once constructed) and its
+    // version, bumped on every reload so workers know when to fetch it
+    std::shared_ptr<const HostTable> get_hosts() const;
+    uint64_t get_hosts_version() const;
+    bool has_hosts_files() const;
+
+    // loads the hosts files again if any of them changed
+    void reload_hosts(bool force = false);
+    uint16_t get_dns_udp_payload_size() const; // 0 = no EDNS
     bool get_client_tcp_nodelay() const;
     bool get_client_tcp_keepalive() const;
     bool get_remote_tcp_nodelay() const;
     bool get_remote_tcp_keepalive() const;
+    bool get_splice_relay() const;
+    size_t get_relay_buffer_size() const;
+    size_t get_relay_high_watermark() const;
+    size_t get_relay_low_watermark() const;
+    size_t get_udp_batch_size() const;
+    bool get_udp_offload() const;
+    bool get_udp_shared_port() const;
+    size_t get_udp_egress_sockets() const;
+    size_t get_udp_flow_limit() const;
+    size_t get_udp_reassembly_size() const;
+    size_t get_max_sessions() const;
+    unsigned int get_handshake_timeout() const;
+    unsigned int get_auth_timeout() const;
+    unsigned int get_dns_timeout() const;
+    unsigned int get_connect_timeout() const;
+    unsigned int get_idle_timeout() const;
+    unsigned int get_udp_flow_timeout() const;
+    unsigned int get_connect_attempt_delay() const;
+
+    // writes the cache snapshot, if there is a cache and a file for it
+    void save_dns_cache() const;
 
     bool authenticate(
         const std::string& username,
@@ -44,16 +87,20 @@ public:
     ) const;
 
 private:
-    Socket _accept_client();
-    Session* _create_new_session(Poller& poller, Socket&& sock);
-    void _delete_session(Session* session);
-    void _delete_all_sessions();
+    void _run_worker(Worker& worker);
 
 private:
     ServerParams _params;
     std::unique_ptr<ServerHook> _hook;
-    std::vector<Session*> _sessions;
-    Socket _server_socket;
+    std::vector<IPAddress> _nameservers;
+    std::unique_ptr<DnsCache> _dns_cache;
+    std::vector<std::string> _hosts_paths;
+    std::vector<std::filesystem::file_time_type> _hosts_mtimes;
+    mutable std::mutex _hosts_mutex; // only held to swap the table
+    std::shared_ptr<const HostTable> _hosts;
+    std::atomic<uint64_t> _hosts_version;
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::atomic<bool> _serving;
 
 }; // class Server
 
@@ -6,6 +6,10 @@
 #include "client_socket.hpp"
 #include "remote_socket.hpp"
 #include "udp_socket.hpp"
+#include "udp_remote_socket.hpp"
+#include "session_pool.hpp"
+
+#include <typeinfo>
 
 namespace sockspp::server
 {
@@ -13,6 +17,8 @@ namespace sockspp::server
 class Server;
 class Session;
 
+// With more than one worker every hook is called concurrently
+// from the worker threads, so implementations must be thread-safe
 class ServerHook
 {
 public:
@@ -25,25 +31,86 @@ public:
     virtual void on_remote_connected(const Server& server, const RemoteSocket& remote) {}
     virtual void on_remote_disconnected(const Server& server, const RemoteSocket& remote) {}
 
+    // Whether established CONNECT sessions may relay with splice()
+    // (see ServerParams::splice_relay). Payload never reaches user space
+    // then, so client/remote send and recv hooks are not called. Custom
+    // hooks don't splice unless they override this and return true.
+    virtual bool can_splice(const Session& session) const
+    {
+        return typeid(*this) == typeid(ServerHook);
+    }
+
+    // The same for the io_uring relay, which receives into buffers of
+    // the poller and sends from the ring buffers of the session without
+    // the client/remote send and recv hooks.
+    virtual bool can_uring_relay(const Session& session) const
+    {
+        return typeid(*this) == typeid(ServerHook);
+    }
+
+    // Whether io_uring may accept clients itself (multishot accept),
+    // client_accept is not called then.
+    virtual bool can_accept_multishot() const
+    {
+        return typeid(*this) == typeid(ServerHook);
+    }
+
     // behavior hooks
-    virtual ClientSocket* create_client_socket(Socket&& sock)
+
+    // Sockets are allocated from the pool of the worker which owns
+    // the session. Hooks creating their own (derived) types have to
+    // override the matching destroy_* hook too.
+    virtual ClientSocket* create_client_socket(SessionPool& pool, Socket&& sock)
+    {
+        return pool.create<ClientSocket>(std::move(sock));
+    }
+
+    virtual void destroy_client_socket(SessionPool& pool, ClientSocket* client_socket)
+    {
+        pool.destroy(client_socket);
+    }
+
+    virtual RemoteSocket* create_remote_socket(
+        SessionPool& pool,
+        Socket&& sock,
+        const IPAddress* address
+    ) {
+        return pool.create<RemoteSocket>(std::move(sock), address);
+    }
+
+    virtual void destroy_remote_socket(SessionPool& pool, RemoteSocket* remote_socket)
     {
-        return new ClientSocket(std::move(sock));
+        pool.destroy(remote_socket);
     }
 
-    virtual RemoteSocket* create_remote_socket(Socket&& sock, const std::vector<IPAddress>* addresses)
+    virtual UDPSocket* create_udp_socket(
+        SessionPool& pool,
+        Socket&& sock,
+        const SocketInfo& client_info
+    ) {
+        return pool.create<UDPSocket>(std::move(sock), client_info);
+    }
+
+    virtual void destroy_udp_socket(SessionPool& pool, UDPSocket* udp_socket)
     {
-        return new RemoteSocket(std::move(sock), addresses);
+        pool.destroy(udp_socket);
     }
 
-    virtual UDPSocket* create_udp_socket(Socket&& sock, const SocketInfo& client_info)
+    virtual UDPRemoteSocket* create_udp_remote_socket(SessionPool& pool, Socket&& sock)
     {
-        return new UDPSocket(std::move(sock), client_info);
+        return pool.create<UDPRemoteSocket>(std::move(sock));
     }
-    
-    virtual sockspp::Socket client_accept(sockspp::Socket& server_socket)
+
+    virtual void destroy_udp_remote_socket(SessionPool& pool, UDPRemoteSocket* remote_socket)
     {
-        return server_socket.accept();
+        pool.destroy(remote_socket);
+    }
+
+    // client must be left non-blocking, -1 when no connection
+    // is waiting (sockerrno is set, EAGAIN ends the batch)
+    virtual int client_accept(sockspp::Socket& server_socket, sockspp::Socket& client)
+    {
+        return server_socket.accept(client);
     }
 
     virtual int client_send(ClientSocket& client_socket, MemoryBuffer& buffer)
@@ -66,14 +133,33 @@ public:
         return remote_socket.recv(buffer);
     }
 
-    virtual int udp_send_to(UDPSocket& udp_socket, MemoryBuffer& buffer, void* addr, int addr_len)
+    // UDP associations: the client side receives datagrams with their
+    // socks header and sends the replies with one (see UDPSocket), the
+    // remote side relays them as they are. Associations sharing the port
+    // of the worker (ServerParams::udp_shared_port) don't call them.
+    virtual int udp_send_batch(UDPSocket& udp_socket, DatagramBatch& batch)
+    {
+        return udp_socket.send_batch(batch);
+    }
+
+    virtual int udp_recv_batch(UDPSocket& udp_socket, DatagramBatch& batch)
+    {
+        return udp_socket.recv_batch(batch);
+    }
+
+    virtual int udp_remote_send_to(UDPRemoteSocket& remote_socket, MemoryBuffer& buffer, void* addr, int addr_len)
+    {
+        return remote_socket.send_to(buffer, addr, addr_len);
+    }
+
+    virtual int udp_remote_send_batch(UDPRemoteSocket& remote_socket, DatagramBatch& batch)
     {
-        return udp_socket.send_to(buffer, addr, addr_len);
+        return remote_socket.send_batch(batch);
     }
 
-    virtual int udp_recv_from(UDPSocket& udp_socket, MemoryBuffer& buffer, void* addr, int* addr_len)
+    virtual int udp_remote_recv_batch(UDPRemoteSocket& remote_socket, DatagramBatch& batch)
     {
-        return udp_socket.recv_from(buffer, addr, addr_len);
+        return remote_socket.recv_batch(batch);
     }
 }; // class ServerHook
 
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <cstdint>
+#include <cstddef>
 
 namespace sockspp::server
 {
@@ -10,14 +11,49 @@ struct ServerParams
 {
     std::string listen_ip;
     uint16_t listen_port = 1080;
+    unsigned int listen_backlog = 1024; // accept queue, capped by net.core.somaxconn
+    size_t accept_batch_size = 64;      // connections accepted per listener event
+    unsigned int tcp_defer_accept = 0;  // seconds to wait for the greeting, 0 = off
     std::string username;
     std::string password;
-    std::string dns_ip;
+    std::string dns_ip; // "auto", "none" or comma separated addresses
     uint16_t dns_port = 53;
+    size_t dns_cache_size = 4096;     // names, 0 = no cache
+    unsigned int dns_negative_ttl = 30; // max seconds to cache failures
+    std::string dns_cache_file;         // snapshot of the cache, empty = none
+    unsigned int dns_cache_save_interval = 300; // seconds, 0 = on shutdown only
+    unsigned int dns_refresh_hits = 8;  // in the refresh window, 0 = never
+    unsigned int dns_refresh_rate = 20; // refreshes per second at most
+    uint16_t dns_udp_payload_size = 1232; // advertised with EDNS0, 0 = no EDNS
+    std::string hosts_file;    // static names, take precedence over the system ones
+    bool system_hosts = true;  // /etc/hosts
     bool client_tcp_nodelay = false;
     bool client_tcp_keepalive = false;
     bool remote_tcp_nodelay = false;
     bool remote_tcp_keepalive = false;
+    bool splice_relay = false;
+    size_t relay_buffer_size = 262144;   // per direction
+    size_t relay_high_watermark = 196608; // stop reading above
+    size_t relay_low_watermark = 65536;   // resume reading below
+    size_t udp_batch_size = 32; // datagrams per recvmmsg()/sendmmsg()
+    bool udp_offload = true; // UDP_SEGMENT/UDP_GRO where the kernel has them
+    bool udp_shared_port = false; // one udp relay port per worker
+    size_t udp_egress_sockets = 64; // per address family and worker (shared port)
+    size_t udp_flow_limit = 256; // remote hosts per udp association
+    size_t udp_reassembly_size = 4194304; // udp fragments held per worker, 0 = dropped
+    unsigned int workers = 1; // 0 = one per CPU core
+    size_t max_sessions = 0;  // 0 = unlimited
+
+    // timeouts in seconds, 0 = disabled
+    unsigned int handshake_timeout = 10; // greeting and command request
+    unsigned int auth_timeout = 10;
+    unsigned int dns_timeout = 10;
+    unsigned int connect_timeout = 10;
+    unsigned int idle_timeout = 300;     // established sessions
+    unsigned int udp_flow_timeout = 120; // remote hosts of udp associations
+
+    // ms before the next address is tried while a connect is pending
+    unsigned int connect_attempt_delay = 250;
 }; // class ServerParams
 
 } // namespace sockspp::server
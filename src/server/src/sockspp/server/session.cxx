@@ -1,9 +1,13 @@
 #include "session.hpp"
 #include "server.hpp"
+#include "worker.hpp"
+#include "session_pool.hpp"
+#include "udp_relay.hpp"
 #include "defs.hpp"
 
 #include <sockspp/core/s5.hpp>
 #include <sockspp/core/errno.hpp>
+#include <sockspp/core/exceptions.hpp>
 #include <sockspp/core/memory_buffer.hpp>
 #include <sockspp/core/poller/event.hpp>
 #include <sockspp/core/log.hpp>
@@ -25,15 +29,28 @@ namespace sockspp::server
 
 Session::Session(
     const Server& server,
-    Poller& poller,
+    Worker& worker,
     Socket&& sock
-)   : _server(server)
-    , _poller(poller)
-    , _client_socket(_server.get_hook()->create_client_socket(std::move(sock)))
+)   : _dns_request([this](const std::vector<IPAddress>& addresses) {
+        _on_resolved(addresses);
+    })
+    , _attempt_timer([this]() {
+        if (!_connect_next())
+            _worker.close_session(this);
+    })
+    , _client_buffer(server.get_relay_buffer_size())
+    , _remote_buffer(server.get_relay_buffer_size())
+    , _server(server)
+    , _worker(worker)
+    , _poller(worker.get_poller())
+    , _timers(worker.get_timers())
+    , _timer([this]() { _on_timeout(); })
+    , _client_socket(_server.get_hook()->create_client_socket(
+        worker.get_pool(),
+        std::move(sock)
+    ))
     , _remote_socket(nullptr)
     , _udp_socket(nullptr)
-    , _client_buffer() // SOCKSPP_SESSION_SOCKET_BUFFER_SIZE
-    , _remote_buffer()
 {
     _server.get_hook()->on_server_accepted_client(_server, *_client_socket);
 }
@@ -41,30 +58,23 @@ Session::Session(
 Session::~Session()
 {
     // delete sockets associated with this session
+    const std::unique_ptr<ServerHook>& hook = _server.get_hook();
+    SessionPool& pool = _worker.get_pool();
 
-    delete _client_socket;
-    _server.get_hook()->on_client_disconnected(_server, *_client_socket);
+    hook->on_client_disconnected(_server, *_client_socket);
+    hook->destroy_client_socket(pool, _client_socket);
 
     if (_remote_socket)
-        delete _remote_socket;
-
-    if (_udp_socket)
-        delete _udp_socket;
+        hook->destroy_remote_socket(pool, _remote_socket);
 
-    for (auto dns_socket : _dns_sockets)
-    {
-        delete dns_socket;
-    }
+    for (RemoteSocket* remote_socket : _connect_attempts)
+        hook->destroy_remote_socket(pool, remote_socket);
 
-    if (_client_buffer.get_ptr())
-    {
-        delete reinterpret_cast<char*>(_client_buffer.get_ptr());
-    }
+    if (_udp_socket)
+        hook->destroy_udp_socket(pool, _udp_socket);
 
-    if (_remote_buffer.get_ptr())
-    {
-        delete reinterpret_cast<char*>(_remote_buffer.get_ptr());
-    }
+    if (_udp_remote_socket)
+        hook->destroy_udp_remote_socket(pool, _udp_remote_socket);
 }
 
 void Session::initialize()
@@ -75,15 +85,14 @@ void Session::initialize()
     _sock.set_nodelay(_server.get_client_tcp_nodelay());
     _sock.set_keepalive(_server.get_client_tcp_keepalive());
 
-    _poller.set_event(
-        _client_socket->get_socket().get_fd(),
+    _set_events(
         _client_socket,
         static_cast<Event::Flags>(Event::Read | Event::Closed)
     );
 
     _peer_info = _client_socket->get_socket().get_peer_address();
 
-    _state = Session::State::Accepted;
+    _set_state(Session::State::Accepted);
     LOGI("Initialize cli:%s", _peer_info.str().c_str());
 }
 
@@ -91,6 +100,25 @@ void Session::shutdown()
 {
     LOGI("Shutdown cli:%s", _peer_info.str().c_str());
 
+    _closed = true;
+    _timer.cancel();
+    _attempt_timer.cancel();
+    _dns_request.cancel();
+
+    for (auto& [name, pending] : _udp_pending)
+        pending->request.cancel();
+
+#if SOCKSPP_POLLER_COMPLETIONS
+    for (const HeldData& held : _client_held)
+        _poller.release_buffer(held.first);
+
+    for (const HeldData& held : _remote_held)
+        _poller.release_buffer(held.first);
+
+    _client_held.clear();
+    _remote_held.clear();
+#endif
+
     // shutdown and unregister all sockets associated with this session
 
     _poller.remove_event(_client_socket->get_socket().get_fd());
@@ -104,36 +132,105 @@ void Session::shutdown()
         _remote_socket->get_socket().close();
     }
 
-    if (_udp_socket)
+    for (RemoteSocket* remote_socket : _connect_attempts)
+        _close_connect_attempt(remote_socket);
+
+    if (_udp_relay)
+    {
+        _udp_relay->detach(*this);
+    }
+    else if (_udp_socket)
     {
         _poller.remove_event(_udp_socket->get_socket().get_fd());
         _udp_socket->get_socket().shutdown();
         _udp_socket->get_socket().close();
     }
 
-    for (auto dns_socket : _dns_sockets)
+    if (_udp_remote_socket)
     {
-        _poller.remove_event(dns_socket->get_socket().get_fd());
-        dns_socket->get_socket().shutdown();
-        dns_socket->get_socket().close();
+        _poller.remove_event(_udp_remote_socket->get_socket().get_fd());
+        _udp_remote_socket->get_socket().shutdown();
+        _udp_remote_socket->get_socket().close();
     }
 }
 
+bool Session::is_closed() const
+{
+    return _closed;
+}
+
 Session::State Session::get_state() const
 {
     return _state;
 }
 
+bool Session::has_pending_io() const
+{
+    return _uring_sends != 0;
+}
+
 bool Session::process_client_event(Event::Flags event_flags)
 {
+    _last_activity = _timers.get_time();
+
     if (event_flags & (Event::Closed | Event::Error))
     {
         return false;
     }
 
+    // readiness reported before the relay moved to completions
+    if (_uring_relay)
+        return true;
+
     if (event_flags & Event::Write)
     {
-        return _session_socket_send(_client_socket, nullptr, _remote_socket, _client_buffer);
+        if (_splice_relay)
+            return _splice_send(_client_socket, _remote_pipe);
+
+        return _session_socket_flush(_client_socket, _client_buffer);
+    }
+
+    if (_splice_relay)
+    {
+        int status = _client_pipe.splice_from(
+            _client_socket->get_socket().get_fd(),
+            SOCKSPP_SESSION_SPLICE_PIPE_SIZE
+        );
+
+        if (status == 0)
+        {
+            return _relay_eof(_client_socket);
+        }
+        else if (status == -1)
+        {
+            if ((sockerrno == SOCKSPP_EWOULDBLOCK) || (sockerrno == SOCKSPP_EAGAIN))
+                return true;
+
+            LOGE("Client splice error (errno: %d)", sockerrno);
+            return false;
+        }
+
+        return _splice_send(_remote_socket, _client_pipe);
+    }
+
+    if (!_remote_buffer.is_empty())
+    {
+        // data is still waiting for the remote, keep the order
+        // and read straight behind it
+        int status = _session_socket_recv(_client_socket, _remote_buffer);
+
+        if (status == 0)
+        {
+            return _relay_eof(_client_socket);
+        }
+        else if (status == -1)
+        {
+            LOGE("Client receive error (errno: %d, session state: %d)", sockerrno, (int)_state);
+            return false;
+        }
+
+        _update_relay_events();
+        return true;
     }
 
     uint8_t _buffer[SOCKSPP_SESSION_SOCKET_BUFFER_SIZE];
@@ -155,35 +252,77 @@ bool Session::process_client_event(Event::Flags event_flags)
         return false;
     }
 
-    return _process_client(buffer, nullptr, 0);
+    return _process_client(buffer);
 }
 
-bool Session::process_remote_event(Event::Flags event_flags)
-{
+bool Session::process_remote_event(
+    Event::Flags event_flags,
+    RemoteSocket* remote_socket
+) {
+    if (_state == Session::State::ConnectingRemote)
+        return _process_connect_event(remote_socket, event_flags);
+
+    if (remote_socket != _remote_socket)
+        return true; // lost the connect race, already closed
+
+    _last_activity = _timers.get_time();
     const std::unique_ptr<ServerHook>& hook = _server.get_hook();
-    if (event_flags & Event::Closed)
+    if (event_flags & (Event::Closed | Event::Error))
     {
         hook->on_remote_disconnected(_server, *_remote_socket);
         return false;
     }
 
-    if (event_flags & Event::Error)
+    if (_uring_relay)
+        return true;
+
+    if (event_flags & Event::Write)
+    {
+        if (_splice_relay)
+            return _splice_send(_remote_socket, _client_pipe);
+
+        return _session_socket_flush(_remote_socket, _remote_buffer);
+    }
+
+    if (_splice_relay)
     {
-        if (!_remote_socket->is_connected())
+        int status = _remote_pipe.splice_from(
+            _remote_socket->get_socket().get_fd(),
+            SOCKSPP_SESSION_SPLICE_PIPE_SIZE
+        );
+
+        if (status == 0)
         {
-            return _remote_socket->try_connect_next();
+            return _relay_eof(_remote_socket);
         }
+        else if (status == -1)
+        {
+            if ((sockerrno == SOCKSPP_EWOULDBLOCK) || (sockerrno == SOCKSPP_EAGAIN))
+                return true;
 
-        hook->on_remote_disconnected(_server, *_remote_socket);
-        return false;
+            LOGE("Remote splice error (errno: %d)", sockerrno);
+            return false;
+        }
+
+        return _splice_send(_client_socket, _remote_pipe);
     }
 
-    if (event_flags & Event::Write)
+    if (_state == Session::State::Connected && !_client_buffer.is_empty())
     {
-        if (!_remote_socket->is_connected())
-            return _remote_socket->could_connect();
+        int status = _session_socket_recv(_remote_socket, _client_buffer);
+
+        if (status == 0)
+        {
+            return _relay_eof(_remote_socket);
+        }
+        else if (status == -1)
+        {
+            LOGE("Remote receive error (errno: %d, session state: %d)", sockerrno, (int)_state);
+            return false;
+        }
 
-        return _session_socket_send(_remote_socket, nullptr, _client_socket, _remote_buffer);
+        _update_relay_events();
+        return true;
     }
 
     uint8_t _buffer[SOCKSPP_SESSION_SOCKET_BUFFER_SIZE];
@@ -194,22 +333,11 @@ bool Session::process_remote_event(Event::Flags event_flags)
     );
 
     int status = -1;
-    sockaddr_storage addr;
-    socklen_t addr_len = sizeof(addr);
 
     if (_state == Session::State::Connected)
     {
         status = _server.get_hook()->remote_recv(*_remote_socket, buffer);
     }
-    else if (_state == Session::State::Associated)
-    {
-        status = _server.get_hook()->udp_recv_from(
-            *reinterpret_cast<UDPSocket*>(_remote_socket),
-            buffer,
-            &addr,
-            reinterpret_cast<int*>(&addr_len)
-        );
-    }
 
     if (status == 0)
     {
@@ -222,68 +350,100 @@ bool Session::process_remote_event(Event::Flags event_flags)
         return false;
     }
 
-    return _process_remote(buffer, &addr, addr_len);
+    return _process_remote(buffer);
 }
 
 bool Session::process_udp_event(Event::Flags event_flags)
 {
+    _last_activity = _timers.get_time();
+
     if (event_flags & (Event::Closed | Event::Error))
     {
         return false;
     }
 
-    char _buffer[SOCKSPP_SESSION_SOCKET_BUFFER_SIZE];
-    MemoryBuffer buffer(
-        _buffer,
-        0,
-        SOCKSPP_SESSION_SOCKET_BUFFER_SIZE
-    );
-
-    sockaddr_storage addr;
-    socklen_t addr_len = sizeof(addr);
-    int status = _udp_socket->recv_from(
-        buffer,
-        &addr,
-        reinterpret_cast<int*>(&addr_len)
-    );
+    // registered edge triggered, batches are received
+    // until one comes back short
+    DatagramBatch& batch = _worker.get_udp_batch();
+    bool more = true;
 
-    if (status == 0)
-    {
-        // invalid source ip, so we drop the packet
-        return true;
-    }
-    else if (status == -1)
+    while (more)
     {
-        return false;
+        int status = _server.get_hook()->udp_recv_batch(*_udp_socket, batch);
+
+        if (status == -1)
+        {
+            return (sockerrno == SOCKSPP_EWOULDBLOCK) || (sockerrno == SOCKSPP_EAGAIN);
+        }
+
+        more = static_cast<size_t>(status) == batch.get_capacity();
+
+        _worker.count_udp_batch(status);
+
+        // the ones sent to a domain name go one by one, they may have
+        // to wait for the resolution
+        size_t count = 0;
+
+        for (size_t i = 0; i < batch.get_size(); i++)
+        {
+            if (batch.get_address_length(i))
+            {
+                if (i != count)
+                    batch.swap(i, count);
+
+                count++;
+                continue;
+            }
+
+            _udp_send_to_domain(batch, i);
+        }
+
+        batch.set_size(count);
+
+        if (count)
+        {
+            _server.get_hook()->udp_remote_send_batch(*_udp_remote_socket, batch);
+        }
     }
 
-    return _process_client(buffer, &addr, addr_len);
+    return true;
 }
 
-bool Session::process_dns_event(Event::Flags event_flags, DnsSocket* dns_socket)
+bool Session::process_udp_remote_event(Event::Flags event_flags)
 {
+    _last_activity = _timers.get_time();
+
     if (event_flags & (Event::Closed | Event::Error))
     {
         return false;
     }
 
-    std::vector<IPAddress>* addresses = new std::vector<IPAddress>();
-    int status = dns_socket->get_response(addresses);
+    return _relay_udp_replies();
+}
 
-    _poller.remove_event(dns_socket->get_socket().get_fd());
+bool Session::relay_udp_request(DatagramBatch& batch, size_t idx)
+{
+    _last_activity = _timers.get_time();
 
-    if (status == 0)
-    {
-        LOGE("DNS Response size: 0");
-        return false;
-    }
-    else if (status == -1)
-    {
-        LOGE("DNS Response receive error (errno: %d)", sockerrno);
+    if (!_udp_socket->translate_request(batch, idx))
         return false;
-    }
 
-    return _do_command(addresses);
+    if (batch.get_address_length(idx))
+        return true;
+
+    _udp_send_to_domain(batch, idx);
+    return false;
+}
+
+bool Session::relay_udp_reply(DatagramBatch& batch, size_t idx)
+{
+    _last_activity = _timers.get_time();
+    return _udp_socket->translate_reply(batch, idx);
+}
+
+const UdpFlowTable& Session::get_udp_flows() const
+{
+    return _udp_socket->get_flows();
 }
 
 bool Session::reply_remote_connection(
@@ -307,7 +467,7 @@ bool Session::reply_remote_connection(
         && (reply == Reply::Success);
 }
 
-bool Session::_process_client(MemoryBuffer& buffer, void* addr, int addr_len)
+bool Session::_process_client(MemoryBuffer& buffer)
 {
     switch (_state)
     {
@@ -344,16 +504,8 @@ bool Session::_process_client(MemoryBuffer& buffer, void* addr, int addr_len)
 
         return _session_socket_send(
             _remote_socket,
-            &buffer,
-            _client_socket,
-            _remote_buffer
-        );
-    case Session::State::Associated:
-        return _server.get_hook()->udp_send_to(
-            *reinterpret_cast<UDPSocket*>(_remote_socket),
             buffer,
-            addr,
-            addr_len
+            _remote_buffer
         );
     default:
         break;
@@ -363,7 +515,7 @@ bool Session::_process_client(MemoryBuffer& buffer, void* addr, int addr_len)
     return false;
 }
 
-bool Session::_process_remote(MemoryBuffer& buffer, void* addr, int addr_len)
+bool Session::_process_remote(MemoryBuffer& buffer)
 {
     switch (_state)
     {
@@ -376,12 +528,9 @@ bool Session::_process_remote(MemoryBuffer& buffer, void* addr, int addr_len)
         );
         return _session_socket_send(
             _client_socket,
-            &buffer,
-            _remote_socket,
+            buffer,
             _client_buffer
         );
-    case Session::State::Associated:
-        return _udp_socket->send_to(buffer, addr, addr_len);
     default:
         break;
     }
@@ -392,164 +541,532 @@ bool Session::_process_remote(MemoryBuffer& buffer, void* addr, int addr_len)
 
 bool Session::_session_socket_send(
     SessionSocket* session_socket,
-    MemoryBuffer* buffer,
-    SessionSocket* session_socket2,
-    MemoryBuffer& scheduled
+    MemoryBuffer& buffer,
+    RingBuffer& scheduled
 ) {
-    bool is_scheduled = scheduled.get_size() > 0;
-    MemoryBuffer& send_buffer = is_scheduled ? scheduled : *buffer;
-
     int res = -1;
     const std::unique_ptr<ServerHook>& hook = _server.get_hook();
 
     // I know, dirty, but hey, not that bad :)
     if (_client_socket == session_socket)
     {
-        res = hook->client_send(*reinterpret_cast<ClientSocket*>(session_socket), send_buffer);
+        res = hook->client_send(*reinterpret_cast<ClientSocket*>(session_socket), buffer);
     }
     else
     {
-        res = hook->remote_send(*reinterpret_cast<RemoteSocket*>(session_socket), send_buffer);
+        res = hook->remote_send(*reinterpret_cast<RemoteSocket*>(session_socket), buffer);
     }
 
-    if (res != send_buffer.get_size())
+    if (res >= 0 && static_cast<size_t>(res) == buffer.get_size())
     {
-        if (
-            (res == -1)
-            && (sockerrno != SOCKSPP_EWOULDBLOCK)
-            && (sockerrno != SOCKSPP_EAGAIN)
-        ) {
-            // Error occured
-            return false;
-        }
+        return true;
+    }
+
+    if (
+        (res == -1)
+        && (sockerrno != SOCKSPP_EWOULDBLOCK)
+        && (sockerrno != SOCKSPP_EAGAIN)
+    ) {
+        // Error occured
+        return false;
+    }
+
+    // Schedule the rest for next WRITE event, scheduled buffer is
+    // empty here and never smaller than the receive buffer
+    size_t sent = res == -1 ? 0 : res;
+    scheduled.write(buffer.as<uint8_t*>() + sent, buffer.get_size() - sent);
+
+    LOGD("Schedule %zu", scheduled.get_size());
+    _update_relay_events();
+
+    return true;
+}
+
+bool Session::_session_socket_flush(
+    SessionSocket* session_socket,
+    RingBuffer& scheduled
+) {
+    const std::unique_ptr<ServerHook>& hook = _server.get_hook();
+
+    while (!scheduled.is_empty())
+    {
+        MemoryBuffer send_buffer = scheduled.get_read_buffer();
+        int res = -1;
 
-        // Schedule buffer for next WRITE event
-        if (!is_scheduled || (res != -1))
+        if (_client_socket == session_socket)
         {
-            size_t sent = res == -1 ? 0 : res;
-            size_t copy_size = send_buffer.get_size() - sent;
+            res = hook->client_send(*reinterpret_cast<ClientSocket*>(session_socket), send_buffer);
+        }
+        else
+        {
+            res = hook->remote_send(*reinterpret_cast<RemoteSocket*>(session_socket), send_buffer);
+        }
 
-            if (scheduled.get_ptr() == nullptr)
+        if (res == -1)
+        {
+            if ((sockerrno != SOCKSPP_EWOULDBLOCK) && (sockerrno != SOCKSPP_EAGAIN))
             {
-                scheduled = MemoryBuffer(
-                    new char[SOCKSPP_SESSION_SOCKET_BUFFER_SIZE],
-                    0,
-                    SOCKSPP_SESSION_SOCKET_BUFFER_SIZE
-                );
+                // Error occured
+                return false;
             }
 
-            scheduled.copy_from(buffer->as<uint8_t*>() + sent, copy_size);
+            break;
         }
 
-        // Listen for WRITE event
-        if (!is_scheduled)
-        {
-            LOGD("Schedule");
-
-            _poller.set_event(
-                session_socket->get_socket().get_fd(),
-                session_socket,
-                static_cast<Event::Flags>(Event::Write | Event::Closed),
-                true
-            );
+        scheduled.consume(res);
 
-            _poller.set_event(
-                session_socket2->get_socket().get_fd(),
-                session_socket2,
-                Event::Closed,
-                true
-            );
+        if (static_cast<size_t>(res) != send_buffer.get_size())
+        {
+            break;
         }
     }
-    else if (is_scheduled)
-    {
-        // Sent scheduled buffer
-        scheduled.set_size(0);
-
-        // Listen for READ event
-        _poller.set_event(
-            session_socket->get_socket().get_fd(),
-            session_socket,
-            static_cast<Event::Flags>(Event::Read | Event::Closed),
-            true
-        );
 
-        _poller.set_event(
-            session_socket2->get_socket().get_fd(),
-            session_socket2,
-            static_cast<Event::Flags>(Event::Read | Event::Closed),
-            true
-        );
+    // the other side is done and everything it sent got through
+    if (scheduled.is_empty()
+        && (session_socket == _client_socket ? _remote_eof : _client_eof))
+    {
+        return false;
     }
 
+    _update_relay_events();
     return true;
-
 }
 
-void Session::_set_state(Session::State state)
-{
-    _state = state;
-}
+int Session::_session_socket_recv(
+    SessionSocket* session_socket,
+    RingBuffer& scheduled
+) {
+    MemoryBuffer buffer = scheduled.get_write_buffer();
 
-bool Session::_check_version(MemoryBuffer& buffer)
-{
-    uint8_t* data = buffer.as<uint8_t*>();
-    if (data[0] == 5)
+    if (!buffer.get_capacity())
     {
-        return true;
+        // full, reading should have been paused already
+        _update_relay_events();
+        return 1;
     }
 
-    _client_socket->send_auth(AuthMethod::Invalid);
-    LOGI("Client invalid version specified: %d", (int)data[0]);
+    int res = -1;
+    const std::unique_ptr<ServerHook>& hook = _server.get_hook();
 
-    return false;
+    if (_client_socket == session_socket)
+    {
+        res = hook->client_recv(*reinterpret_cast<ClientSocket*>(session_socket), buffer);
+    }
+    else
+    {
+        res = hook->remote_recv(*reinterpret_cast<RemoteSocket*>(session_socket), buffer);
+    }
+
+    if (res > 0)
+    {
+        scheduled.commit(res);
+    }
+    else if (res == -1
+        && ((sockerrno == SOCKSPP_EWOULDBLOCK) || (sockerrno == SOCKSPP_EAGAIN)))
+    {
+        return 1;
+    }
+
+    return res;
 }
 
-bool Session::_request_auth(MemoryBuffer& buffer)
+// The same as _session_socket_flush, but the pending data
+// stays in the kernel pipe instead of a user space buffer
+bool Session::_splice_send(SessionSocket* session_socket, Pipe& pipe)
 {
-    uint8_t* data = buffer.as<uint8_t*>();
-    AuthMethod auth_method = _server.get_auth_method();
-    AuthMethod selected_method = AuthMethod::Invalid;
+    int fd = session_socket->get_socket().get_fd();
 
-    for (uint8_t i = 0; i < data[1]; i++)
+    while (pipe.get_size())
     {
-        AuthMethod method = static_cast<AuthMethod>(data[i + 2]);
+        int res = pipe.splice_to(fd, pipe.get_size());
 
-        if (method == auth_method)
+        if (res == -1)
         {
-            selected_method = method;
+            if ((sockerrno != SOCKSPP_EWOULDBLOCK) && (sockerrno != SOCKSPP_EAGAIN))
+            {
+                // Error occured
+                return false;
+            }
+
             break;
         }
-    }
 
-    if (!_client_socket->send_auth(selected_method))
-    {
-        return false;
+        LOGD(
+            "TCP | %s %s %s | %d (splice)",
+            _peer_info.str().c_str(),
+            session_socket == _remote_socket ? "->" : "<-",
+            _remote_socket->get_remote_info().str().c_str(),
+            res
+        );
     }
 
-    if (selected_method != auth_method)
+    if (!pipe.get_size()
+        && (session_socket == _client_socket ? _remote_eof : _client_eof))
     {
         return false;
     }
 
-    if (selected_method == AuthMethod::NoAuth)
+    _update_relay_events();
+    return true;
+}
+
+// The peer won't send anything more, the session ends
+// once the data it sent before reaches the other side
+bool Session::_relay_eof(SessionSocket* session_socket)
+{
+    size_t pending = 0;
+
+    if (session_socket == _client_socket)
     {
-        _set_state(Session::State::Authenticated);
+        _client_eof = true;
+        pending = _splice_relay
+            ? _client_pipe.get_size()
+            : _remote_buffer.get_size();
     }
-    else if (selected_method == AuthMethod::UserPass)
+    else
     {
-        _set_state(Session::State::AuthRequested);
+        _remote_eof = true;
+        pending = _splice_relay
+            ? _remote_pipe.get_size()
+            : _client_buffer.get_size();
+
+        _server.get_hook()->on_remote_disconnected(_server, *_remote_socket);
     }
 
+    if (!pending)
+        return false;
+
+    _update_relay_events();
     return true;
 }
 
-bool Session::_handle_auth(MemoryBuffer& buffer)
+// Reading from a socket goes on until the data pending for the other
+// side reaches the high watermark and resumes once it drains to the
+// low watermark, WRITE is only listened for while something is pending
+void Session::_update_relay_events()
 {
-    uint8_t* data = buffer.as<uint8_t*>();
-    size_t data_size = buffer.get_size();
+    size_t to_remote = _splice_relay
+        ? _client_pipe.get_size()
+        : _remote_buffer.get_size();
 
-    data += 1; // skip version
+    size_t to_client = _splice_relay
+        ? _remote_pipe.get_size()
+        : _client_buffer.get_size();
+
+    // a pipe with data in it can't tell us how much more it takes
+    size_t high_watermark = _splice_relay ? 1 : _server.get_relay_high_watermark();
+    size_t low_watermark = _splice_relay ? 0 : _server.get_relay_low_watermark();
+
+    if (to_remote >= high_watermark)
+        _client_read_paused = true;
+    else if (to_remote <= low_watermark)
+        _client_read_paused = false;
+
+    if (to_client >= high_watermark)
+        _remote_read_paused = true;
+    else if (to_client <= low_watermark)
+        _remote_read_paused = false;
+
+    if (_uring_relay)
+    {
+        // sends are queued right away instead of waiting for WRITE,
+        // paused sockets are only watched for hang ups
+        _set_events(
+            _client_socket,
+            (_client_read_paused || _client_eof) ? Event::Closed : Event::Received
+        );
+
+        _set_events(
+            _remote_socket,
+            (_remote_read_paused || _remote_eof) ? Event::Closed : Event::Received
+        );
+
+        return;
+    }
+
+    uint32_t client_flags = Event::Closed;
+    uint32_t remote_flags = Event::Closed;
+
+    if (!_client_read_paused && !_client_eof)
+        client_flags |= Event::Read;
+
+    if (!_remote_read_paused && !_remote_eof)
+        remote_flags |= Event::Read;
+
+    if (to_client)
+        client_flags |= Event::Write;
+
+    if (to_remote)
+        remote_flags |= Event::Write;
+
+    _set_events(_client_socket, static_cast<Event::Flags>(client_flags));
+    _set_events(_remote_socket, static_cast<Event::Flags>(remote_flags));
+}
+
+#if SOCKSPP_POLLER_COMPLETIONS
+// The io_uring relay: data is received into buffers provided by the
+// poller and copied into the ring buffers, which are sent from by the
+// poller too, one send at a time per socket. Neither waits for the
+// socket to be ready and the loop submits them all at once.
+bool Session::process_completion(SessionSocket* session_socket, const Event& event)
+{
+    if (event.get_flags() & Event::Sent)
+    {
+        _uring_sends--;
+        session_socket->_sending = 0;
+    }
+
+    if (_closed)
+        return true;
+
+    _last_activity = _timers.get_time();
+
+    if (event.get_flags() & Event::Sent)
+        return _uring_sent(session_socket, event.get_result());
+
+    return _uring_received(session_socket, event);
+}
+
+bool Session::_uring_received(SessionSocket* session_socket, const Event& event)
+{
+    if (event.get_result() == 0)
+    {
+        return _relay_eof(session_socket);
+    }
+
+    bool from_client = session_socket == _client_socket;
+    RingBuffer& scheduled = from_client ? _remote_buffer : _client_buffer;
+    std::deque<HeldData>& held = from_client ? _remote_held : _client_held;
+
+    const uint8_t* data = event.get_data();
+    size_t size = event.get_result();
+    size_t written = held.empty() ? scheduled.write(data, size) : 0;
+
+    if (written < size)
+    {
+        // reading is paused already, this one was on its way
+        _poller.hold_buffer(data);
+        held.emplace_back(data + written, size - written);
+    }
+
+    SessionSocket* other = from_client
+        ? static_cast<SessionSocket*>(_remote_socket)
+        : static_cast<SessionSocket*>(_client_socket);
+
+    return _uring_send(other, scheduled);
+}
+
+bool Session::_uring_sent(SessionSocket* session_socket, int res)
+{
+    bool to_client = session_socket == _client_socket;
+
+    if (res < 0)
+    {
+        LOGE("%s send error (errno: %d)", to_client ? "Client" : "Remote", -res);
+        return false;
+    }
+
+    RingBuffer& scheduled = to_client ? _client_buffer : _remote_buffer;
+    std::deque<HeldData>& held = to_client ? _client_held : _remote_held;
+
+    scheduled.consume(res);
+
+    // held data moves into the freed space
+    while (!held.empty())
+    {
+        HeldData& front = held.front();
+        size_t written = scheduled.write(front.first, front.second);
+
+        if (written < front.second)
+        {
+            front.first += written;
+            front.second -= written;
+            break;
+        }
+
+        _poller.release_buffer(front.first);
+        held.pop_front();
+    }
+
+    // the other side is done and everything it sent got through
+    if (scheduled.is_empty() && (to_client ? _remote_eof : _client_eof))
+    {
+        return false;
+    }
+
+    return _uring_send(session_socket, scheduled);
+}
+
+bool Session::_uring_send(SessionSocket* session_socket, RingBuffer& scheduled)
+{
+    if (!session_socket->_sending && !scheduled.is_empty())
+    {
+        MemoryBuffer buffer = scheduled.get_read_buffer();
+
+        if (!_poller.send(
+            session_socket->get_socket().get_fd(),
+            session_socket,
+            buffer.as<void*>(),
+            buffer.get_size()
+        )) {
+            LOGE("Couldn't queue a send (errno: %d)", errno);
+            return false;
+        }
+
+        session_socket->_sending = buffer.get_size();
+        _uring_sends++;
+    }
+
+    _update_relay_events();
+    return true;
+}
+#endif
+
+bool Session::_set_events(SessionSocket* session_socket, Event::Flags flags)
+{
+    if (session_socket->_event_flags == flags)
+    {
+        return true;
+    }
+
+    bool is_mod = session_socket->_event_flags != 0;
+    session_socket->_event_flags = flags;
+
+    return _poller.set_event(
+        session_socket->get_socket().get_fd(),
+        session_socket,
+        flags,
+        is_mod
+    );
+}
+
+void Session::_set_state(Session::State state)
+{
+    _state = state;
+
+    unsigned int timeout = 0;
+
+    switch (state)
+    {
+    case Session::State::Accepted:
+    case Session::State::Authenticated:
+        timeout = _server.get_handshake_timeout();
+        break;
+    case Session::State::AuthRequested:
+        timeout = _server.get_auth_timeout();
+        break;
+    case Session::State::ResolvingDomainName:
+        timeout = _server.get_dns_timeout();
+        break;
+    case Session::State::ConnectingRemote:
+        timeout = _server.get_connect_timeout();
+        break;
+    case Session::State::Connected:
+    case Session::State::Associated:
+        timeout = _server.get_idle_timeout();
+        _last_activity = _timers.get_time();
+        break;
+    default:
+        break;
+    }
+
+    if (timeout)
+        _timers.arm(_timer, timeout * 1000ull);
+    else
+        _timer.cancel();
+}
+
+void Session::_on_timeout()
+{
+    if (_state == Session::State::Connected
+        || _state == Session::State::Associated)
+    {
+        // the idle timer is not moved on every packet,
+        // check the last activity when it fires instead
+        uint64_t idle = _timers.get_time() - _last_activity;
+        uint64_t timeout = _server.get_idle_timeout() * 1000ull;
+
+        if (idle < timeout)
+        {
+            _timers.arm(_timer, timeout - idle);
+            return;
+        }
+    }
+    else if (_state == Session::State::ResolvingDomainName
+        || _state == Session::State::ConnectingRemote)
+    {
+        uint8_t address[4] = { 0 };
+        _client_socket->send_reply(Reply::TTLExpired, AddrType::IPv4, address, 0);
+    }
+
+    LOGI(
+        "Timeout cli:%s (session state: %d)",
+        _peer_info.str().c_str(),
+        (int)_state
+    );
+
+    _worker.close_session(this);
+}
+
+bool Session::_check_version(MemoryBuffer& buffer)
+{
+    uint8_t* data = buffer.as<uint8_t*>();
+    if (data[0] == 5)
+    {
+        return true;
+    }
+
+    _client_socket->send_auth(AuthMethod::Invalid);
+    LOGI("Client invalid version specified: %d", (int)data[0]);
+
+    return false;
+}
+
+bool Session::_request_auth(MemoryBuffer& buffer)
+{
+    uint8_t* data = buffer.as<uint8_t*>();
+    AuthMethod auth_method = _server.get_auth_method();
+    AuthMethod selected_method = AuthMethod::Invalid;
+
+    for (uint8_t i = 0; i < data[1]; i++)
+    {
+        AuthMethod method = static_cast<AuthMethod>(data[i + 2]);
+
+        if (method == auth_method)
+        {
+            selected_method = method;
+            break;
+        }
+    }
+
+    if (!_client_socket->send_auth(selected_method))
+    {
+        return false;
+    }
+
+    if (selected_method != auth_method)
+    {
+        return false;
+    }
+
+    if (selected_method == AuthMethod::NoAuth)
+    {
+        _set_state(Session::State::Authenticated);
+    }
+    else if (selected_method == AuthMethod::UserPass)
+    {
+        _set_state(Session::State::AuthRequested);
+    }
+
+    return true;
+}
+
+bool Session::_handle_auth(MemoryBuffer& buffer)
+{
+    uint8_t* data = buffer.as<uint8_t*>();
+    size_t data_size = buffer.get_size();
+
+    data += 1; // skip version
     uint8_t username_len = data[0];
 
     if (username_len > (data_size - 2))
@@ -630,7 +1147,8 @@ std::vector<IPAddress>* Session::_resolve_address(MemoryBuffer& buffer, bool* is
     case AddrType::IPv4:
     case AddrType::IPv6:
         {
-            std::vector<IPAddress>* addresses = new std::vector<IPAddress>();
+            std::vector<IPAddress>* addresses = &_addresses;
+            addresses->clear();
 
             addresses->emplace_back(
                 type == AddrType::IPv4
@@ -644,17 +1162,61 @@ std::vector<IPAddress>* Session::_resolve_address(MemoryBuffer& buffer, bool* is
             return addresses;
         }
     case AddrType::DomainName:
-        *is_domain_name = _resolve_domain_name(buffer);
-        if (!*is_domain_name)
         {
-            LOGD("Attempted to resolve domain, but dns is `None`");
-            _client_socket->send_reply(
-                Reply::AddrTypeNotSupported,
-                type,
-                address.get_address(),
-                address.get_port()
-            );
+            uint8_t* domain_name_data = address.get_address();
+            _domain_name = std::string((char*)domain_name_data+1, *domain_name_data);
+
+            // pinned names are answered right away, no dns at all
+            _addresses.clear();
+
+            if (_worker.get_hosts().lookup(_domain_name, address.get_port(), _addresses))
+            {
+                LOGD("HOSTS | %s", _domain_name.c_str());
+                return &_addresses;
+            }
+
+            DnsCache* dns_cache = _server.get_dns_cache();
+            DnsCache::Status status = DnsCache::Status::Miss;
+
+            if (dns_cache)
+            {
+                _addresses.clear();
+                status = dns_cache->lookup(
+                    _domain_name,
+                    address.get_port(),
+                    _timers.get_time(),
+                    _addresses
+                );
+            }
+
+            // a cached answer skips the dns round trip entirely
+            if (status == DnsCache::Status::Hit)
+            {
+                LOGD("DNS CACHE | %s", _domain_name.c_str());
+                return &_addresses;
+            }
+            else if (status == DnsCache::Status::Refresh)
+            {
+                // a popular name about to expire, the next sessions
+                // find the new answer in the cache already
+                LOGD("DNS CACHE | %s (refreshing)", _domain_name.c_str());
+                _worker.get_resolver().refresh(_domain_name);
+                return &_addresses;
+            }
+            else if (status == DnsCache::Status::Negative)
+            {
+                LOGD("DNS CACHE | %s (no answer)", _domain_name.c_str());
+                _reply_failure(Reply::HostUnreachable);
+                return nullptr;
+            }
         }
+
+        *is_domain_name = _resolve_domain_name(buffer);
+
+        // the query couldn't be sent, see _resolve_domain_name
+        if (!*is_domain_name)
+            _reply_failure(Reply::GeneralFailure);
+
         return nullptr;
     default:
         LOGE("Unsupported address type: %d", static_cast<int>(type));
@@ -672,63 +1234,56 @@ std::vector<IPAddress>* Session::_resolve_address(MemoryBuffer& buffer, bool* is
 
 bool Session::_resolve_domain_name(MemoryBuffer& buffer)
 {
-    if (_dns_sockets.size() >= SOCKSPP_SESSION_MAX_DNS_SOCKETS)
+    if (_server.get_nameservers().empty())
     {
+        LOGE("DNS QUERY | %s, no nameserver to ask", _domain_name.c_str());
         return false;
     }
 
-    if (_server.get_dns_ip().empty())
+    S5CommandMessage message(buffer.as<uint8_t*>());
+    _domain_port = message.get_address().get_port();
+
+    if (!_worker.get_resolver().resolve(_domain_name, _dns_request))
     {
+        LOGE("DNS QUERY | %s couldn't be sent", _domain_name.c_str());
         return false;
     }
 
-    IPAddress dns_address(
-        _server.get_dns_ip(),
-        _server.get_dns_port()
-    );
-
-    Socket sock = dns_address.get_version() == IPAddress::Version::IPv4
-        ? Socket::open_udp()
-        : Socket::open_udp6();
-
-    S5CommandMessage message(buffer.as<uint8_t*>());
-    S5Address address = message.get_address();
-
-    uint8_t* domain_name_data = address.get_address();
-    _domain_name = std::string((char*)domain_name_data+1, *domain_name_data);
-    uint16_t port = address.get_port();
-
-    DnsSocket* dns_socket = new DnsSocket(
-        std::move(sock),
-        _domain_name,
-        port
-    );
-
-    dns_socket->set_session(*this);
-
-    _dns_sockets.push_back(dns_socket);
+    _set_state(Session::State::ResolvingDomainName);
+    return true;
+}
 
-    _poller.set_event(
-        dns_socket->get_socket().get_fd(),
-        dns_socket,
-        static_cast<Event::Flags>(Event::Read | Event::Closed)
-    );
+void Session::_on_resolved(const std::vector<IPAddress>& addresses)
+{
+    if (addresses.empty())
+    {
+        LOGD("DNS QUERY | %s (no answer)", _domain_name.c_str());
+        _reply_failure(Reply::HostUnreachable);
+        _worker.close_session(this);
+        return;
+    }
 
-    _set_state(Session::State::ResolvingDomainName);
-    int status = dns_socket->query(dns_address);
+    _addresses.clear();
 
-    if (status == 0)
+    for (const IPAddress& address : addresses)
     {
-        LOGE("DNS Query error");
-        return false;
+        _addresses.emplace_back(
+            address.get_version(),
+            address.get_address(),
+            _domain_port
+        );
     }
-    else if (status == -1)
+
+    if (!_do_command(&_addresses))
     {
-        LOGE("DNS Query error (errno: %d)", sockerrno);
-        return false;
+        _worker.close_session(this);
     }
+}
 
-    return status > 0;
+void Session::_reply_failure(Reply reply)
+{
+    uint8_t address[4] = { 0 };
+    _client_socket->send_reply(reply, AddrType::IPv4, address, 0);
 }
 
 bool Session::_do_command(
@@ -742,19 +1297,14 @@ bool Session::_do_command(
     switch (_command)
     {
     case Command::Connect:
-        {
-            Socket sock =
-                addresses->at(0).get_version() == IPAddress::Version::IPv4
-                ? Socket::open_tcp()
-                : Socket::open_tcp6();
-
-            _server.get_hook()->on_remote_socket_created(_server, sock);
-            _connect_remote(std::move(sock), addresses);
-        }
-        break;
+        return _connect_remote();
     case Command::UdpAssociate:
         {
             bool is_ipv4 = addresses->at(0).get_version() == IPAddress::Version::IPv4;
+            _udp_version = addresses->at(0).get_version();
+
+            if (_worker.get_udp_relay())
+                return _associate_shared(addresses->at(0).get_port());
 
             Socket cl_sock = is_ipv4
                 ? Socket::open_udp()
@@ -775,38 +1325,216 @@ bool Session::_do_command(
     return true;
 }
 
-bool Session::_connect_remote(
-    Socket&& sock,
-    const std::vector<IPAddress>* addresses
-) {
-    _remote_socket = _server.get_hook()->create_remote_socket(std::move(sock), addresses);
-    _remote_socket->set_session(*this);
-    Socket& _sock = _remote_socket->get_socket();
-    _sock.set_nodelay(_server.get_remote_tcp_nodelay());
-    _sock.set_keepalive(_server.get_remote_tcp_keepalive());
+bool Session::_connect_remote()
+{
+    // RFC 8305: alternate the address families, IPv6 first,
+    // so a broken family costs one attempt delay at most
+    bool has_ipv4 = false;
+    bool has_ipv6 = false;
+
+    for (const IPAddress& address : _addresses)
+    {
+        if (address.get_version() == IPAddress::Version::IPv4)
+            has_ipv4 = true;
+        else
+            has_ipv6 = true;
+    }
+
+    if (has_ipv4 && has_ipv6)
+    {
+        std::vector<IPAddress> addresses;
+        addresses.reserve(_addresses.size());
+        size_t ipv4_idx = 0;
+        size_t ipv6_idx = 0;
+        bool ipv6 = true;
+
+        while (addresses.size() < _addresses.size())
+        {
+            IPAddress::Version version = ipv6
+                ? IPAddress::Version::IPv6
+                : IPAddress::Version::IPv4;
+            size_t& idx = ipv6 ? ipv6_idx : ipv4_idx;
+
+            while (idx < _addresses.size()
+                && _addresses[idx].get_version() != version)
+            {
+                idx++;
+            }
+
+            if (idx < _addresses.size())
+                addresses.push_back(_addresses[idx++]);
+
+            ipv6 = !ipv6;
+        }
+
+        _addresses.swap(addresses);
+    }
+
+    _connect_idx = 0;
+    _connect_pending = 0;
+    _connect_error = 0;
 
     _set_state(Session::State::ConnectingRemote);
-    if (!_remote_socket->process_event(Event::Error))  // start connect attempts
+    return _connect_next();
+}
+
+bool Session::_connect_next()
+{
+    const std::unique_ptr<ServerHook>& hook = _server.get_hook();
+
+    while (_connect_idx < _addresses.size())
     {
-        return false;
+        const IPAddress* address = &_addresses[_connect_idx++];
+        RemoteSocket* remote_socket = nullptr;
+
+        try {
+            Socket sock = address->get_version() == IPAddress::Version::IPv4
+                ? Socket::open_tcp()
+                : Socket::open_tcp6();
+
+            hook->on_remote_socket_created(_server, sock);
+            remote_socket = hook->create_remote_socket(
+                _worker.get_pool(),
+                std::move(sock),
+                address
+            );
+        } catch (const SocketCreationException& ex) {
+            LOGD("TCP | Couldn't open remote socket (errno: %d)", ex.code());
+            _connect_error = ex.code();
+            continue;
+        }
+
+        remote_socket->set_session(*this);
+        _connect_attempts.push_back(remote_socket);
+
+        Socket& _sock = remote_socket->get_socket();
+        _sock.set_nodelay(_server.get_remote_tcp_nodelay());
+        _sock.set_keepalive(_server.get_remote_tcp_keepalive());
+
+        if (!remote_socket->connect()
+            || !_set_events(
+                remote_socket,
+                static_cast<Event::Flags>(Event::Write | Event::Closed)))
+        {
+            // failed right away (no route, no such family...), next one
+            _connect_error = sockerrno;
+            _close_connect_attempt(remote_socket);
+            continue;
+        }
+
+        _connect_pending++;
+
+        // the next address gets a chance if this one is slow
+        if (_connect_idx < _addresses.size())
+            _timers.arm(_attempt_timer, _server.get_connect_attempt_delay());
+
+        return true;
     }
-    
-    _poller.set_event(
-        _sock.get_fd(),
-        _remote_socket,
-        static_cast<Event::Flags>(Event::Write | Event::Closed)
+
+    if (_connect_pending)
+        return true;
+
+    Reply reply = Reply::GeneralFailure;
+
+    switch (_connect_error)
+    {
+    case SOCKSPP_ECONNREFUSED:
+        reply = Reply::ConnectionRefused;
+        break;
+    case SOCKSPP_ENETUNREACH:
+        reply = Reply::Unreachable;
+        break;
+    case SOCKSPP_EHOSTUNREACH:
+        reply = Reply::HostUnreachable;
+        break;
+    case SOCKSPP_ETIMEDOUT:
+        reply = Reply::TTLExpired;
+        break;
+    default:
+        break;
+    }
+
+    const IPAddress& address = _addresses.back();
+
+    LOGE("TCP | Couldn't connect (errno: %d)", _connect_error);
+    reply_remote_connection(
+        reply,
+        address.get_version() == IPAddress::Version::IPv4
+            ? AddrType::IPv4
+            : AddrType::IPv6,
+        address.get_address(),
+        address.get_port()
     );
 
-    return true;
+    return false;
+}
+
+bool Session::_process_connect_event(
+    RemoteSocket* remote_socket,
+    Event::Flags event_flags
+) {
+    auto found = std::find(
+        _connect_attempts.begin(),
+        _connect_attempts.end(),
+        remote_socket
+    );
+
+    // stale event of an attempt closed in this poll batch
+    if (found == _connect_attempts.end()
+        || remote_socket->get_socket().get_fd() == -1)
+    {
+        return true;
+    }
+
+    int error = remote_socket->get_socket().get_error();
+
+    if (!error && !(event_flags & (Event::Closed | Event::Error)))
+    {
+        if (!(event_flags & Event::Write))
+            return true;
+
+        // first one to connect wins, the others are dropped
+        _attempt_timer.cancel();
+        _connect_attempts.erase(found);
+
+        for (RemoteSocket* attempt : _connect_attempts)
+            _close_connect_attempt(attempt);
+
+        _connect_pending = 0;
+        _remote_socket = remote_socket;
+        return _remote_socket->could_connect();
+    }
+
+    LOGD("TCP | Connect attempt failed (errno: %d)", error);
+
+    if (error)
+        _connect_error = error;
+
+    _close_connect_attempt(remote_socket);
+    _connect_pending--;
+
+    // don't wait for the attempt delay after a failure
+    _attempt_timer.cancel();
+    return _connect_next();
+}
+
+void Session::_close_connect_attempt(RemoteSocket* remote_socket)
+{
+    Socket& sock = remote_socket->get_socket();
+
+    if (sock.get_fd() == -1)
+        return;
+
+    // destroyed with the session, events of this batch may still point to it
+    _poller.remove_event(sock.get_fd());
+    sock.close();
 }
 
 void Session::_remote_connected()
 {
-    _poller.set_event(
-        _remote_socket->get_socket().get_fd(),
+    _set_events(
         _remote_socket,
-        static_cast<Event::Flags>(Event::Read | Event::Closed),
-        true
+        static_cast<Event::Flags>(Event::Read | Event::Closed)
     );
 
 #if !SOCKSPP_DISABLE_LOGS
@@ -822,8 +1550,31 @@ void Session::_remote_connected()
     );
 #endif
 
+    const std::unique_ptr<ServerHook>& hook = _server.get_hook();
+
+    if (_server.get_splice_relay() && hook->can_splice(*this))
+    {
+        _splice_relay = _client_pipe.open(SOCKSPP_SESSION_SPLICE_PIPE_SIZE)
+            && _remote_pipe.open(SOCKSPP_SESSION_SPLICE_PIPE_SIZE);
+
+        if (!_splice_relay)
+        {
+            LOGW("Couldn't open splice pipes (errno: %d), copying instead", sockerrno);
+            _client_pipe.close();
+            _remote_pipe.close();
+        }
+    }
+
+#if SOCKSPP_POLLER_COMPLETIONS
+    if (!_splice_relay && _poller.has_completions() && hook->can_uring_relay(*this))
+    {
+        _uring_relay = true;
+        _update_relay_events();
+    }
+#endif
+
     _set_state(Session::State::Connected);
-    _server.get_hook()->on_remote_connected(_server, *_remote_socket);
+    hook->on_remote_connected(_server, *_remote_socket);
 }
 
 bool Session::_associate(Socket&& cl_sock, Socket&& rm_sock)
@@ -870,22 +1621,40 @@ bool Session::_associate(Socket&& cl_sock, Socket&& rm_sock)
 
     auto& hook = _server.get_hook();
 
-    _udp_socket = hook->create_udp_socket(std::move(cl_sock), _peer_info);
+    _udp_socket = hook->create_udp_socket(
+        _worker.get_pool(),
+        std::move(cl_sock),
+        _peer_info
+    );
     _udp_socket->set_session(*this);
+    _udp_socket->get_flows().configure(
+        _server.get_udp_flow_limit(),
+        _server.get_udp_flow_timeout() * 1000ull,
+        &_timers,
+        &_worker.get_udp_flow_stats()
+    );
+    _udp_socket->get_fragments().configure(_timers, _worker.get_udp_reassembly());
 
-    _poller.set_event(
-        _udp_socket->get_socket().get_fd(),
+    _set_events(
         _udp_socket,
-        static_cast<Event::Flags>(Event::Read | Event::Closed)
+        static_cast<Event::Flags>(Event::Read | Event::Closed | Event::Edge)
     );
 
-    _remote_socket = hook->create_remote_socket(std::move(rm_sock), nullptr);
-    _remote_socket->set_session(*this);
+    _udp_remote_socket = hook->create_udp_remote_socket(
+        _worker.get_pool(),
+        std::move(rm_sock)
+    );
+    _udp_remote_socket->set_session(*this);
 
-    _poller.set_event(
-        _remote_socket->get_socket().get_fd(),
-        _remote_socket,
-        static_cast<Event::Flags>(Event::Read | Event::Closed)
+    if (_server.get_udp_offload())
+    {
+        _udp_socket->enable_udp_offload(false);
+        _udp_remote_socket->enable_udp_offload(true);
+    }
+
+    _set_events(
+        _udp_remote_socket,
+        static_cast<Event::Flags>(Event::Read | Event::Closed | Event::Edge)
     );
 
     LOGI(
@@ -898,4 +1667,243 @@ bool Session::_associate(Socket&& cl_sock, Socket&& rm_sock)
     return true;
 }
 
+bool Session::_associate_shared(uint16_t client_port)
+{
+    UdpRelay* relay = _worker.get_udp_relay();
+    SocketInfo bound_info = _client_socket->get_socket().get_bound_address();
+    bound_info.port = relay->get_port();
+
+    if (!_client_socket->send_reply(
+        Reply::Success,
+        bound_info.ip_version == SocketInfo::IPv4
+            ? AddrType::IPv4
+            : AddrType::IPv6,
+        bound_info.ip,
+        ntohs(bound_info.port)
+    )) {
+        LOGD("failed sending association reply");
+        return false;
+    }
+
+    // no socket of its own, it only keeps the state of the association
+    // (client address, port maps, domain destination)
+    _udp_socket = _server.get_hook()->create_udp_socket(
+        _worker.get_pool(),
+        Socket(-1),
+        _peer_info
+    );
+    _udp_socket->set_session(*this);
+    _udp_socket->get_flows().configure(
+        _server.get_udp_flow_limit(),
+        _server.get_udp_flow_timeout() * 1000ull,
+        &_timers,
+        &_worker.get_udp_flow_stats()
+    );
+    _udp_socket->get_fragments().configure(_timers, _worker.get_udp_reassembly());
+
+    SocketInfo client_info = _peer_info;
+    client_info.port = htons(client_port);
+    relay->attach(*this, client_info);
+    _udp_relay = relay;
+
+    LOGI(
+        "UDP ASSOCIATE | cli:%s <-> bnd:%s (shared)",
+        _peer_info.str().c_str(),
+        bound_info.str().c_str()
+    );
+
+    _set_state(Session::State::Associated);
+    return true;
+}
+
+bool Session::_relay_udp_replies()
+{
+    // edge triggered as well, see process_udp_event()
+    DatagramBatch& batch = _worker.get_udp_batch();
+    bool more = true;
+
+    while (more)
+    {
+        int status = _server.get_hook()->udp_remote_recv_batch(*_udp_remote_socket, batch);
+
+        if (status == -1)
+        {
+            if ((sockerrno == SOCKSPP_EWOULDBLOCK) || (sockerrno == SOCKSPP_EAGAIN))
+                return true;
+
+            LOGE("Remote receive error (errno: %d, session state: %d)", sockerrno, (int)_state);
+            return false;
+        }
+
+        more = static_cast<size_t>(status) == batch.get_capacity();
+
+        _worker.count_udp_batch(status);
+        _server.get_hook()->udp_send_batch(*_udp_socket, batch);
+    }
+
+    return true;
+}
+
+void Session::_udp_send_to_domain(DatagramBatch& batch, size_t idx)
+{
+    MemoryBuffer data = batch.get_data(idx);
+    size_t header_size = _udp_socket->take_domain_destination(data.as<uint8_t*>());
+    MemoryBuffer buffer(
+        data.as<uint8_t*>() + header_size,
+        data.get_size() - header_size,
+        data.get_capacity() - header_size
+    );
+
+    const std::string& name = _udp_socket->get_domain_name();
+    uint16_t port = _udp_socket->get_domain_port();
+
+    _addresses.clear();
+
+    if (_worker.get_hosts().lookup(name, 0, _addresses))
+    {
+        _udp_send(buffer, _addresses, port);
+        return;
+    }
+
+    DnsCache* dns_cache = _server.get_dns_cache();
+
+    if (dns_cache)
+    {
+        DnsCache::Status status = dns_cache->lookup(
+            name,
+            0,
+            _timers.get_time(),
+            _addresses
+        );
+
+        if (status == DnsCache::Status::Refresh)
+            _worker.get_resolver().refresh(name);
+
+        if (status == DnsCache::Status::Hit || status == DnsCache::Status::Refresh)
+        {
+            _udp_send(buffer, _addresses, port);
+            return;
+        }
+
+        if (status == DnsCache::Status::Negative)
+        {
+            LOGD("UDP | %s (no answer), datagram dropped", name.c_str());
+            return;
+        }
+    }
+
+    if (_server.get_nameservers().empty())
+    {
+        LOGD("UDP | %s, no dns to resolve it", name.c_str());
+        return;
+    }
+
+    // the datagrams wait for one resolution of their name, the finished
+    // resolutions are forgotten (not from their own callbacks)
+    auto pending = _udp_pending.find(name);
+
+    if (pending == _udp_pending.end() || !pending->second->request.is_pending())
+    {
+        std::erase_if(_udp_pending, [](const auto& item) {
+            return !item.second->request.is_pending();
+        });
+
+        if (_udp_pending.size() >= SOCKSPP_SESSION_UDP_PENDING_NAMES)
+        {
+            LOGD("UDP | %s, too many names resolving, datagram dropped", name.c_str());
+            return;
+        }
+
+        std::unique_ptr<UdpPendingName> entry(new UdpPendingName{
+            DnsRequest([this, name](const std::vector<IPAddress>& addresses) {
+                _flush_udp_pending(name, addresses);
+            }),
+            {}
+        });
+
+        if (!_worker.get_resolver().resolve(name, entry->request))
+        {
+            LOGE("DNS Query error");
+            return;
+        }
+
+        pending = _udp_pending.emplace(name, std::move(entry)).first;
+    }
+
+    auto& datagrams = pending->second->datagrams;
+
+    if (datagrams.size() >= SOCKSPP_SESSION_UDP_QUEUE_SIZE)
+    {
+        LOGD("UDP | %s, resolution queue full, datagram dropped", name.c_str());
+        return;
+    }
+
+    uint8_t* payload = buffer.as<uint8_t*>();
+    datagrams.emplace_back(port, std::vector<uint8_t>(payload, payload + buffer.get_size()));
+}
+
+void Session::_udp_send(
+    MemoryBuffer& buffer,
+    const std::vector<IPAddress>& addresses,
+    uint16_t port
+) {
+    // the remote socket has the family of the association
+    auto address = std::find_if(addresses.begin(), addresses.end(),
+        [this](const IPAddress& address) {
+            return address.get_version() == _udp_version;
+        });
+
+    if (address == addresses.end())
+    {
+        LOGD("UDP | no address of the association family, datagram dropped");
+        return;
+    }
+
+    IPAddress remote(address->get_version(), address->get_address(), port);
+    sockaddr_storage addr;
+    int addr_len = remote.to_sockaddr(&addr);
+    _udp_socket->add_flow(&addr);
+
+    if (_udp_relay)
+    {
+        _udp_relay->send_to(*this, buffer, &addr, addr_len);
+        return;
+    }
+
+    _server.get_hook()->udp_remote_send_to(
+        *_udp_remote_socket,
+        buffer,
+        &addr,
+        addr_len
+    );
+}
+
+void Session::_flush_udp_pending(
+    const std::string& name,
+    const std::vector<IPAddress>& addresses
+) {
+    auto pending = _udp_pending.find(name);
+
+    if (_closed || pending == _udp_pending.end())
+        return;
+
+    auto& datagrams = pending->second->datagrams;
+
+    if (addresses.empty())
+    {
+        LOGD("UDP | %s couldn't be resolved, %zu datagrams dropped", name.c_str(), datagrams.size());
+    }
+    else
+    {
+        for (auto& [port, payload] : datagrams)
+        {
+            MemoryBuffer buffer(payload.data(), payload.size(), payload.size());
+            _udp_send(buffer, addresses, port);
+        }
+    }
+
+    datagrams.clear();
+    datagrams.shrink_to_fit();
+}
+
 } // namespace sockspp::server
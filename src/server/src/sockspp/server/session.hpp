@@ -3,21 +3,31 @@
 #include "client_socket.hpp"
 #include "remote_socket.hpp"
 #include "udp_socket.hpp"
-#include "dns_socket.hpp"
+#include "udp_remote_socket.hpp"
+#include "resolver.hpp"
 
 #include <sockspp/core/memory_buffer.hpp>
 #include <sockspp/core/buffer.hpp>
+#include <sockspp/core/pipe.hpp>
+#include <sockspp/core/ring_buffer.hpp>
+#include <sockspp/core/timer_wheel.hpp>
 #include <sockspp/core/poller/poller.hpp>
 #include <sockspp/core/socket.hpp>
 #include <sockspp/core/ip_address.hpp>
 #include <sockspp/core/s5_enums.hpp>
 
 #include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <unordered_map>
 
 namespace sockspp::server
 {
 
 class Server;
+class Worker;
+class UdpRelay;
 
 class Session
 {
@@ -37,19 +47,34 @@ public:
 public:
     Session(
         const Server& server,
-        Poller& poller,
+        Worker& worker,
         Socket&& sock
     );
     ~Session();
 
     void initialize();
     void shutdown();
+    bool is_closed() const;
     State get_state() const;
 
     bool process_client_event(Event::Flags event_flags);
-    bool process_remote_event(Event::Flags event_flags);
+    bool process_remote_event(
+        Event::Flags event_flags,
+        RemoteSocket* remote_socket);
     bool process_udp_event(Event::Flags event_flags);
-    bool process_dns_event(Event::Flags event_flags, DnsSocket* dns_socket);
+    bool process_udp_remote_event(Event::Flags event_flags);
+
+#if SOCKSPP_POLLER_COMPLETIONS
+    // Event::Received/Sent of the io_uring relay
+    bool process_completion(SessionSocket* session_socket, const Event& event);
+#endif
+
+    bool has_pending_io() const; // must not be destroyed before they end
+
+    // datagrams of the shared udp relay, false if they're not relayed
+    bool relay_udp_request(DatagramBatch& batch, size_t idx);
+    bool relay_udp_reply(DatagramBatch& batch, size_t idx);
+    const UdpFlowTable& get_udp_flows() const; // once associated
 
     bool reply_remote_connection(
         Reply reply,
@@ -60,15 +85,32 @@ public:
 
 private:
     void _set_state(State state);
+    void _on_timeout();
 
-    bool _process_client(MemoryBuffer& buffer, void* addr, int addr_len);
-    bool _process_remote(MemoryBuffer& buffer, void* addr, int addr_len);
+    bool _process_client(MemoryBuffer& buffer);
+    bool _process_remote(MemoryBuffer& buffer);
     bool _session_socket_send(
         SessionSocket* session_socket,
-        MemoryBuffer* buffer,
-        SessionSocket* session_socket2,
-        MemoryBuffer& _scheduled
+        MemoryBuffer& buffer,
+        RingBuffer& scheduled
+    );
+    bool _session_socket_flush(
+        SessionSocket* session_socket,
+        RingBuffer& scheduled
+    );
+    int _session_socket_recv(
+        SessionSocket* session_socket,
+        RingBuffer& scheduled
     );
+    bool _splice_send(SessionSocket* session_socket, Pipe& pipe);
+    bool _relay_eof(SessionSocket* session_socket);
+    void _update_relay_events();
+#if SOCKSPP_POLLER_COMPLETIONS
+    bool _uring_received(SessionSocket* session_socket, const Event& event);
+    bool _uring_sent(SessionSocket* session_socket, int res);
+    bool _uring_send(SessionSocket* session_socket, RingBuffer& scheduled);
+#endif
+    bool _set_events(SessionSocket* session_socket, Event::Flags flags);
 
     bool _check_version(MemoryBuffer& buffer);
     bool _request_auth(MemoryBuffer& buffer);
@@ -78,27 +120,84 @@ private:
         MemoryBuffer& buffer,
         bool* is_domain_name);
     bool _resolve_domain_name(MemoryBuffer& buffer);
+    void _on_resolved(const std::vector<IPAddress>& addresses);
+    void _reply_failure(Reply reply); // before closing, no bound address
     bool _do_command(const std::vector<IPAddress>* addresses = nullptr);
-    bool _connect_remote(
-        Socket&& sock,
-        const std::vector<IPAddress>* addresses);
+    bool _connect_remote();
+    bool _connect_next();
+    bool _process_connect_event(
+        RemoteSocket* remote_socket,
+        Event::Flags event_flags);
+    void _close_connect_attempt(RemoteSocket* remote_socket);
     void _remote_connected();
     bool _associate(Socket&& cl_sock, Socket&& rm_sock);
+    bool _associate_shared(uint16_t client_port);
+    bool _relay_udp_replies();
+    void _udp_send_to_domain(DatagramBatch& batch, size_t idx);
+    void _udp_send(
+        MemoryBuffer& buffer,
+        const std::vector<IPAddress>& addresses,
+        uint16_t port);
+    void _flush_udp_pending(
+        const std::string& name,
+        const std::vector<IPAddress>& addresses);
 
 private:
-    std::vector<DnsSocket*> _dns_sockets;
+    // received data which didn't fit the ring buffer (io_uring relay),
+    // it stays in the buffer of the poller until there's room
+    using HeldData = std::pair<const uint8_t*, size_t>;
+
+    // udp datagrams waiting for the resolution of their destination
+    struct UdpPendingName
+    {
+        DnsRequest request;
+        std::vector<std::pair<uint16_t, std::vector<uint8_t>>> datagrams; // port, payload
+    };
+
+    std::vector<IPAddress> _addresses; // remote addresses to connect to
     std::string _domain_name;
-    MemoryBuffer _client_buffer;
-    MemoryBuffer _remote_buffer;
+    uint16_t _domain_port = 0;
+    DnsRequest _dns_request;
+    std::vector<RemoteSocket*> _connect_attempts; // racing remote sockets
+    size_t _connect_idx = 0;  // next address to try
+    size_t _connect_pending = 0;
+    int _connect_error = 0;
+    Timer _attempt_timer; // starts the next attempt (Happy Eyeballs)
+    RingBuffer _client_buffer; // pending data for the client
+    RingBuffer _remote_buffer; // pending data for the remote
+    Pipe _client_pipe; // client -> remote (splice relay)
+    Pipe _remote_pipe; // remote -> client (splice relay)
+    std::deque<HeldData> _client_held; // remote -> client (io_uring relay)
+    std::deque<HeldData> _remote_held; // client -> remote (io_uring relay)
+    size_t _uring_sends = 0; // queued in the poller
     SocketInfo _peer_info;
     const Server& _server;
+    Worker& _worker;
     Poller& _poller;
+    TimerWheel& _timers;
+    Timer _timer; // timeout of the current state
+    uint64_t _last_activity = 0;
     ClientSocket* _client_socket;
     RemoteSocket* _remote_socket;
     UDPSocket* _udp_socket;
+    UDPRemoteSocket* _udp_remote_socket = nullptr;
+    UdpRelay* _udp_relay = nullptr; // shared relay of the association
+    IPAddress::Version _udp_version = IPAddress::Version::IPv4; // of the remote socket
+    std::unordered_map<std::string, std::unique_ptr<UdpPendingName>> _udp_pending;
     
     State _state = State::Invalid;
     Command _command = Command::Invalid;
+    bool _splice_relay = false;
+    bool _uring_relay = false;
+    bool _client_read_paused = false;
+    bool _remote_read_paused = false;
+    bool _client_eof = false; // nothing more to read, pending data is
+    bool _remote_eof = false; // still delivered to the other side
+    bool _closed = false; // shut down, waiting to be reclaimed
+
+    // index in the session table of the owning worker
+    size_t _slot = 0;
+    friend class Worker;
 }; // class Session
 
 } // namespace sockspp::server
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "session.hpp"
+#include "client_socket.hpp"
+#include "remote_socket.hpp"
+#include "udp_socket.hpp"
+#include "udp_remote_socket.hpp"
+
+#include <sockspp/core/object_pool.hpp>
+
+#include <tuple>
+
+namespace sockspp::server
+{
+
+// Per worker storage for sessions and their sockets, preallocated
+// for the expected number of sessions and growing in slabs beyond it
+class SessionPool
+{
+public:
+    SessionPool(size_t capacity)
+        : _pools(capacity, capacity, capacity, capacity, capacity)
+    {
+        std::apply([capacity](auto&... pool) {
+            (pool.reserve(capacity), ...);
+        }, _pools);
+    }
+
+    SessionPool(const SessionPool& other) = delete;
+
+    template <typename T, typename... Args>
+    T* create(Args&&... args)
+    {
+        return std::get<ObjectPool<T>>(_pools).create(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    void destroy(T* object)
+    {
+        std::get<ObjectPool<T>>(_pools).destroy(object);
+    }
+
+    template <typename T>
+    const ObjectPool<T>& get() const
+    {
+        return std::get<ObjectPool<T>>(_pools);
+    }
+
+private:
+    std::tuple<
+        ObjectPool<Session>,
+        ObjectPool<ClientSocket>,
+        ObjectPool<RemoteSocket>,
+        ObjectPool<UDPSocket>,
+        ObjectPool<UDPRemoteSocket>
+    > _pools;
+
+}; // class SessionPool
+
+} // namespace sockspp::server
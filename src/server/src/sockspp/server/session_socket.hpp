@@ -1,6 +1,7 @@
 #pragma once
 
 #include <sockspp/core/socket.hpp>
+#include <sockspp/core/datagram_batch.hpp>
 #include <sockspp/core/poller/poller.hpp>
 
 namespace sockspp::server
@@ -89,6 +90,38 @@ public:
         );
     }
 
+    virtual int recv_batch(DatagramBatch& batch)
+    {
+        return batch.recv_from(this->get_socket().get_fd());
+    }
+
+    virtual int send_batch(DatagramBatch& batch)
+    {
+        return this->send_batch(batch, 0, batch.get_size());
+    }
+
+    int send_batch(DatagramBatch& batch, size_t begin, size_t end)
+    {
+        return batch.send_to(this->get_socket().get_fd(), begin, end, &_udp_gso);
+    }
+
+    // udp offloads of the socket (Linux), GRO is only asked for where
+    // the datagrams are relayed without a header of their own, GSO is
+    // used if the kernel has it
+    void enable_udp_offload(bool gro)
+    {
+        _udp_gso = _sock.has_udp_gso();
+
+        if (gro)
+            _sock.set_udp_gro(true);
+    }
+
+    // sockets without a session belong to the worker (resolver)
+    inline bool has_session() const
+    {
+        return _session != nullptr;
+    }
+
     inline Session& get_session() const
     {
         // be careful, I am lazy to improve this part
@@ -109,6 +142,9 @@ protected:
 private:
     const Session* _session = nullptr;
     Socket _sock;
+    Event::Flags _event_flags = static_cast<Event::Flags>(0); // registered in poller
+    size_t _sending = 0; // bytes queued in the poller (io_uring relay)
+    bool _udp_gso = false; // turned off when the kernel refuses it
 
 }; // class SessionSocket
 
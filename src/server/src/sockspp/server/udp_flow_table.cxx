@@ -0,0 +1,223 @@
+#include "udp_flow_table.hpp"
+
+#include <sockspp/core/socket.hpp>
+
+#include <cstring>
+
+namespace sockspp::server
+{
+
+static constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+
+UdpEndpoint::UdpEndpoint(const void* sock_addr, uint8_t socket)
+{
+    SocketInfo info;
+    memset(&info, 0, sizeof(info));
+    info.from(const_cast<void*>(sock_addr));
+
+    memcpy(ip, info.ip, sizeof(ip));
+    port = info.port;
+    version = info.ip_version;
+    this->socket = socket;
+}
+
+bool UdpEndpoint::operator==(const UdpEndpoint& other) const
+{
+    return port == other.port
+        && version == other.version
+        && socket == other.socket
+        && memcmp(ip, other.ip, version == SocketInfo::IPv4 ? 4 : 16) == 0;
+}
+
+size_t UdpEndpointHash::operator()(const UdpEndpoint& endpoint) const
+{
+    // FNV-1a of the significant bytes
+    uint64_t hash = 0xCBF29CE484222325ull;
+    size_t ip_size = endpoint.version == SocketInfo::IPv4 ? 4 : 16;
+
+    auto mix = [&hash](const uint8_t* data, size_t size) {
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= data[i];
+            hash *= 0x100000001B3ull;
+        }
+    };
+
+    mix(endpoint.ip, ip_size);
+    mix(reinterpret_cast<const uint8_t*>(&endpoint.port), sizeof(endpoint.port));
+    mix(&endpoint.socket, sizeof(endpoint.socket));
+
+    return static_cast<size_t>(hash);
+}
+
+UdpFlowTable::UdpFlowTable() {}
+
+void UdpFlowTable::configure(
+    size_t limit,
+    uint64_t timeout,
+    const TimerWheel* timers,
+    Stats* stats
+) {
+    _limit = limit ? limit : 1;
+    _timeout = timeout;
+    _timers = timers;
+    _stats = stats;
+}
+
+void UdpFlowTable::update(const void* remote, uint16_t client_port)
+{
+    UdpEndpoint endpoint(remote);
+    uint64_t now = _get_time();
+    size_t idx = _find(endpoint);
+
+    if (idx != NOT_FOUND)
+    {
+        _slots[idx].client_port = client_port;
+        _slots[idx].last_use = now;
+        return;
+    }
+
+    if (_size >= _limit)
+        _evict(now);
+
+    if ((_size + 1) * 2 > _slots.size())
+        _grow();
+
+    _insert(Slot{ endpoint, now, client_port });
+}
+
+uint16_t UdpFlowTable::lookup(const void* remote)
+{
+    if (!_size)
+        return 0;
+
+    size_t idx = _find(UdpEndpoint(remote));
+
+    if (idx == NOT_FOUND)
+        return 0;
+
+    Slot& slot = _slots[idx];
+    uint64_t now = _get_time();
+
+    if (_timeout && now - slot.last_use > _timeout)
+    {
+        _erase(idx);
+
+        if (_stats)
+            _stats->expired++;
+
+        return 0;
+    }
+
+    slot.last_use = now;
+    return slot.client_port;
+}
+
+bool UdpFlowTable::contains(UdpEndpoint remote) const
+{
+    remote.socket = 0;
+    return _size && _find(remote) != NOT_FOUND;
+}
+
+size_t UdpFlowTable::get_size() const
+{
+    return _size;
+}
+
+uint64_t UdpFlowTable::_get_time() const
+{
+    return _timers ? _timers->get_time() : TimerWheel::now();
+}
+
+size_t UdpFlowTable::_find(const UdpEndpoint& remote) const
+{
+    if (_slots.empty())
+        return NOT_FOUND;
+
+    size_t mask = _slots.size() - 1;
+
+    for (size_t i = UdpEndpointHash()(remote) & mask;
+        _slots[i].client_port;
+        i = (i + 1) & mask)
+    {
+        if (_slots[i].remote == remote)
+            return i;
+    }
+
+    return NOT_FOUND;
+}
+
+void UdpFlowTable::_insert(const Slot& slot)
+{
+    size_t mask = _slots.size() - 1;
+    size_t i = UdpEndpointHash()(slot.remote) & mask;
+
+    while (_slots[i].client_port)
+    {
+        i = (i + 1) & mask;
+    }
+
+    _slots[i] = slot;
+    _size++;
+}
+
+void UdpFlowTable::_erase(size_t idx)
+{
+    size_t mask = _slots.size() - 1;
+    size_t hole = idx;
+
+    // the next entries of the run move back into the hole,
+    // unless their home slot lies between the hole and them
+    for (size_t i = (hole + 1) & mask; _slots[i].client_port; i = (i + 1) & mask)
+    {
+        size_t home = UdpEndpointHash()(_slots[i].remote) & mask;
+
+        if (((i - home) & mask) >= ((i - hole) & mask))
+        {
+            _slots[hole] = _slots[i];
+            hole = i;
+        }
+    }
+
+    _slots[hole].client_port = 0;
+    _size--;
+}
+
+void UdpFlowTable::_evict(uint64_t now)
+{
+    // one pass over the slots, only when the table is full
+    size_t oldest = NOT_FOUND;
+
+    for (size_t i = 0; i < _slots.size(); i++)
+    {
+        if (!_slots[i].client_port)
+            continue;
+
+        if (oldest == NOT_FOUND || _slots[i].last_use < _slots[oldest].last_use)
+            oldest = i;
+    }
+
+    if (oldest == NOT_FOUND)
+        return;
+
+    bool idle = _timeout && now - _slots[oldest].last_use > _timeout;
+    _erase(oldest);
+
+    if (_stats)
+        (idle ? _stats->expired : _stats->evicted)++;
+}
+
+void UdpFlowTable::_grow()
+{
+    std::vector<Slot> slots(_slots.empty() ? 8 : _slots.size() * 2);
+    slots.swap(_slots);
+    _size = 0;
+
+    for (const Slot& slot : slots)
+    {
+        if (slot.client_port)
+            _insert(slot);
+    }
+}
+
+} // namespace sockspp::server
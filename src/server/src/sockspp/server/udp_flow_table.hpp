@@ -0,0 +1,85 @@
+#pragma once
+
+#include <sockspp/core/timer_wheel.hpp>
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace sockspp::server
+{
+
+// Address of a client, or of a remote host as seen by one egress socket
+struct UdpEndpoint
+{
+    uint8_t ip[16];
+    uint16_t port;   // network byte order
+    uint8_t version; // SocketInfo::IPVersion
+    uint8_t socket;  // egress socket index, 0 for clients
+
+    UdpEndpoint() = default;
+    UdpEndpoint(const void* sock_addr, uint8_t socket = 0);
+
+    bool operator==(const UdpEndpoint& other) const;
+}; // struct UdpEndpoint
+
+struct UdpEndpointHash
+{
+    size_t operator()(const UdpEndpoint& endpoint) const;
+}; // struct UdpEndpointHash
+
+// Remote hosts of a udp association, with the client port their replies
+// go to. Open addressing with linear probing over a power of two array
+// that grows up to twice the limit, entries are removed by shifting the
+// next ones back (no tombstones). A flow idle for longer than the timeout
+// is forgotten when it's looked up, and a full table evicts its least
+// recently used flow.
+class UdpFlowTable
+{
+public:
+    struct Stats
+    {
+        uint64_t expired = 0; // idle for longer than the timeout
+        uint64_t evicted = 0; // dropped to make room for a new one
+    };
+
+    UdpFlowTable();
+
+    // limit: flows at most, timeout: ms, 0 = never idle
+    void configure(size_t limit, uint64_t timeout, const TimerWheel* timers, Stats* stats);
+
+    // remote: sockaddr of the remote host, client_port: network byte order
+    void update(const void* remote, uint16_t client_port);
+    // client port of the remote host, 0 if unknown or expired
+    uint16_t lookup(const void* remote);
+    // whether the remote host is known, whatever its socket
+    bool contains(UdpEndpoint remote) const;
+
+    size_t get_size() const;
+
+private:
+    struct Slot
+    {
+        UdpEndpoint remote;
+        uint64_t last_use;    // ms
+        uint16_t client_port; // 0 = free slot
+    };
+
+    uint64_t _get_time() const;
+    size_t _find(const UdpEndpoint& remote) const;
+    void _insert(const Slot& slot);
+    void _erase(size_t idx);
+    void _evict(uint64_t now);
+    void _grow();
+
+private:
+    std::vector<Slot> _slots; // allocated on first use
+    size_t _size = 0;
+    size_t _limit = 256;
+    uint64_t _timeout = 0;
+    const TimerWheel* _timers = nullptr;
+    Stats* _stats = nullptr;
+
+}; // class UdpFlowTable
+
+} // namespace sockspp::server
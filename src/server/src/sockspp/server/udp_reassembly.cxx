@@ -0,0 +1,175 @@
+#include "udp_reassembly.hpp"
+#include "defs.hpp"
+
+#include <sockspp/core/s5.hpp>
+#include <sockspp/core/log.hpp>
+
+#include <cstring>
+
+namespace sockspp::server
+{
+
+UdpFragmentQueue::UdpFragmentQueue()
+    : _timer([this]() {
+        LOGD("UDP | reassembly timeout, fragments dropped");
+        _drop();
+    }) {}
+
+UdpFragmentQueue::~UdpFragmentQueue()
+{
+    clear();
+}
+
+void UdpFragmentQueue::configure(TimerWheel& timers, UdpReassembly& reassembly)
+{
+    clear();
+    _timers = &timers;
+    _reassembly = &reassembly;
+}
+
+size_t UdpFragmentQueue::add(
+    uint8_t* data,
+    size_t size,
+    size_t header_size,
+    size_t capacity
+) {
+    S5UDPHeader header(data);
+    uint8_t position = header.get_frag() & 0x7F;
+    bool last = header.get_frag() & 0x80;
+
+    if (!_reassembly || !position)
+        return 0;
+
+    if (position == 1)
+    {
+        // a new sequence, the current one is given up
+        _drop();
+    }
+    else if (position != _position + 1)
+    {
+        LOGD("UDP | fragment %u out of order, dropped", position);
+        _drop();
+        return 0;
+    }
+
+    size_t added = (position == 1 ? header_size : 0) + size - header_size;
+
+    if (_data.size() + added > capacity)
+    {
+        LOGD("UDP | reassembled datagram too large, sequence dropped");
+        _drop();
+        return 0;
+    }
+
+    // may drop this sequence too when it's the oldest one
+    if (!_reassembly->_reserve(*this, added))
+    {
+        _drop();
+        return 0;
+    }
+
+    if (position == 1)
+    {
+        _reassembly->_link(*this);
+        _timers->arm(_timer, SOCKSPP_SESSION_UDP_REASSEMBLY_TIMEOUT);
+
+        _data.assign(data, data + header_size);
+        S5UDPHeader(_data.data()).set_frag(0);
+    }
+
+    _data.insert(_data.end(), data + header_size, data + size);
+    _position = position;
+
+    if (!last)
+        return 0;
+
+    size_t total = _data.size();
+    memcpy(data, _data.data(), total);
+    clear();
+
+    return total;
+}
+
+void UdpFragmentQueue::clear()
+{
+    if (!_position)
+        return;
+
+    _reassembly->_size -= _data.size();
+    _reassembly->_unlink(*this);
+    _timer.cancel();
+
+    std::vector<uint8_t>().swap(_data);
+    _position = 0;
+}
+
+void UdpFragmentQueue::_drop()
+{
+    if (!_position)
+        return;
+
+    _reassembly->_dropped++;
+    clear();
+}
+
+UdpReassembly::UdpReassembly(size_t limit)
+    : _limit(limit) {}
+
+size_t UdpReassembly::get_size() const
+{
+    return _size;
+}
+
+uint64_t UdpReassembly::get_dropped() const
+{
+    return _dropped;
+}
+
+void UdpReassembly::_link(UdpFragmentQueue& queue)
+{
+    queue._prev = _newest;
+    queue._next = nullptr;
+
+    if (_newest)
+        _newest->_next = &queue;
+    else
+        _oldest = &queue;
+
+    _newest = &queue;
+}
+
+void UdpReassembly::_unlink(UdpFragmentQueue& queue)
+{
+    if (queue._prev)
+        queue._prev->_next = queue._next;
+    else
+        _oldest = queue._next;
+
+    if (queue._next)
+        queue._next->_prev = queue._prev;
+    else
+        _newest = queue._prev;
+
+    queue._prev = nullptr;
+    queue._next = nullptr;
+}
+
+bool UdpReassembly::_reserve(UdpFragmentQueue& queue, size_t size)
+{
+    if (size > _limit)
+        return false;
+
+    while (_size + size > _limit)
+    {
+        UdpFragmentQueue* oldest = _oldest;
+        oldest->_drop();
+
+        if (oldest == &queue)
+            return false;
+    }
+
+    _size += size;
+    return true;
+}
+
+} // namespace sockspp::server
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <sockspp/core/timer_wheel.hpp>
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace sockspp::server
+{
+
+class UdpReassembly;
+
+// Fragments of one udp association put back together (RFC 1928, 7.).
+// The queue holds one sequence at a time: it starts with fragment 1,
+// takes the next positions in order and completes with the one marked
+// last. A fragment out of order, or the reassembly timer, drops it.
+class UdpFragmentQueue
+{
+public:
+    UdpFragmentQueue();
+    UdpFragmentQueue(const UdpFragmentQueue& other) = delete;
+    ~UdpFragmentQueue();
+
+    void configure(TimerWheel& timers, UdpReassembly& reassembly);
+
+    // data: a fragment with its header, capacity: room at data.
+    // Returns the size of the complete datagram written over the
+    // fragment (header of the first fragment, FRAG cleared),
+    // 0 while it isn't complete or if it's dropped
+    size_t add(uint8_t* data, size_t size, size_t header_size, size_t capacity);
+
+    void clear();
+
+private:
+    void _drop();
+
+private:
+    Timer _timer;
+    TimerWheel* _timers = nullptr;
+    UdpReassembly* _reassembly = nullptr;
+    std::vector<uint8_t> _data; // header of the first fragment, payloads
+    uint8_t _position = 0;      // of the last fragment, 0 = no sequence
+    UdpFragmentQueue* _prev = nullptr; // started sequences of the worker,
+    UdpFragmentQueue* _next = nullptr; // oldest first
+
+    friend class UdpReassembly;
+}; // class UdpFragmentQueue
+
+// Memory taken by the partial sequences of a worker's associations.
+// When a fragment doesn't fit, the oldest sequences are dropped.
+class UdpReassembly
+{
+public:
+    UdpReassembly(size_t limit); // bytes, 0 = fragments are dropped
+    UdpReassembly(const UdpReassembly& other) = delete;
+
+    size_t get_size() const;
+    uint64_t get_dropped() const; // incomplete sequences
+
+private:
+    void _link(UdpFragmentQueue& queue);
+    void _unlink(UdpFragmentQueue& queue);
+    bool _reserve(UdpFragmentQueue& queue, size_t size);
+
+private:
+    size_t _limit;
+    size_t _size = 0;
+    uint64_t _dropped = 0;
+    UdpFragmentQueue* _oldest = nullptr;
+    UdpFragmentQueue* _newest = nullptr;
+
+    friend class UdpFragmentQueue;
+}; // class UdpReassembly
+
+} // namespace sockspp::server
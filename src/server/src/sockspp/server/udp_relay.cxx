@@ -0,0 +1,493 @@
+#include "udp_relay.hpp"
+#include "server.hpp"
+#include "worker.hpp"
+#include "session.hpp"
+#include "defs.hpp"
+
+#include <sockspp/core/ip_address.hpp>
+#include <sockspp/core/errno.hpp>
+#include <sockspp/core/exceptions.hpp>
+#include <sockspp/core/poller/event.hpp>
+#include <sockspp/core/log.hpp>
+
+#include <cstring>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <sys/socket.h>
+    #include <netinet/in.h>
+#endif
+
+namespace sockspp::server
+{
+
+UdpRelaySocket::UdpRelaySocket(Socket&& sock, UdpRelay& relay, uint8_t index)
+    : SessionSocket(std::move(sock))
+    , _relay(relay)
+    , _index(index) {}
+
+uint8_t UdpRelaySocket::get_index() const
+{
+    return _index;
+}
+
+bool UdpRelaySocket::process_event(Event::Flags event_flags)
+{
+    return _relay.process_event(this, event_flags);
+}
+
+UdpRelay::UdpRelay(const Server& server, Worker& worker)
+    : _server(server)
+    , _worker(worker)
+    , _poller(worker.get_poller())
+    , _targets(server.get_udp_batch_size())
+{
+}
+
+UdpRelay::~UdpRelay()
+{
+    if (_client_socket)
+        _poller.remove_event(_client_socket->get_socket().get_fd());
+
+    for (auto& pool : _egress)
+    {
+        for (auto& egress : pool)
+            _poller.remove_event(egress->get_socket().get_fd());
+    }
+}
+
+void UdpRelay::open(const std::string& ip)
+{
+    IPAddress address(ip, 0);
+
+    Socket sock = address.get_version() == IPAddress::Version::IPv4
+        ? Socket::open_udp()
+        : Socket::open_udp6();
+
+    sock.set_blocking(false);
+    sock.bind(ip, 0);
+    _ip = ip;
+    _port = sock.get_bound_address().port;
+
+    _client_socket = std::make_unique<UdpRelaySocket>(std::move(sock), *this, 0);
+
+    if (_server.get_udp_offload())
+        _client_socket->enable_udp_offload(false);
+
+    if (!_poller.register_event(Event(
+            _client_socket->get_socket().get_fd(),
+            static_cast<Event::Flags>(Event::Read | Event::Closed | Event::Edge),
+            reinterpret_cast<void*>(_client_socket.get()))))
+    {
+        throw SocketCreationException();
+    }
+}
+
+uint16_t UdpRelay::get_port() const
+{
+    return _port;
+}
+
+void UdpRelay::attach(Session& session, const SocketInfo& client)
+{
+    sockaddr_storage addr;
+    int addr_len = 0;
+    memset(&addr, 0, sizeof(addr));
+
+    SocketInfo info = client;
+    info.to(&addr, &addr_len);
+
+    UdpEndpoint endpoint(&addr);
+    Association association{ endpoint, endpoint.port != 0, _next_egress++, {} };
+
+    if (association.bound)
+    {
+        // the latest association of a client address takes it over
+        _clients[endpoint] = &session;
+    }
+    else
+    {
+        _unbound.emplace(endpoint, &session);
+    }
+
+    _associations.emplace(&session, std::move(association));
+}
+
+void UdpRelay::detach(Session& session)
+{
+    auto association = _associations.find(&session);
+
+    if (association == _associations.end())
+        return;
+
+    const UdpEndpoint& client = association->second.client;
+
+    if (association->second.bound)
+    {
+        auto found = _clients.find(client);
+
+        if (found != _clients.end() && found->second == &session)
+            _clients.erase(found);
+    }
+    else
+    {
+        auto [begin, end] = _unbound.equal_range(client);
+
+        for (auto it = begin; it != end; it++)
+        {
+            if (it->second == &session)
+            {
+                _unbound.erase(it);
+                break;
+            }
+        }
+    }
+
+    for (const UdpEndpoint& flow : association->second.flows)
+    {
+        auto found = _flows.find(flow);
+
+        if (found != _flows.end() && found->second == &session)
+            _flows.erase(found);
+    }
+
+    _associations.erase(association);
+}
+
+int UdpRelay::send_to(
+    Session& session,
+    MemoryBuffer& buffer,
+    void* addr,
+    int addr_len
+) {
+    UdpRelaySocket* egress = _route(session, addr);
+
+    if (!egress)
+        return 0;
+
+    return egress->get_socket().send_to(
+        buffer.as<const char*>(),
+        buffer.get_size(),
+        addr,
+        addr_len
+    );
+}
+
+bool UdpRelay::process_event(UdpRelaySocket* relay_socket, Event::Flags event_flags)
+{
+    if (event_flags & Event::Closed)
+    {
+        LOGE("UDP relay socket closed (errno: %d)", relay_socket->get_socket().get_error());
+        _reopen(relay_socket);
+        return true;
+    }
+
+    if (event_flags & Event::Error)
+    {
+        // error of an earlier datagram (e.g. port unreachable), reading
+        // it clears it, the datagrams that came with it are still relayed
+        int error = relay_socket->get_socket().get_error();
+        LOGD("UDP relay socket error (errno: %d)", error);
+    }
+
+    // registered edge triggered, the socket is drained
+    if (relay_socket == _client_socket.get())
+    {
+        while (_relay_requests());
+    }
+    else
+    {
+        while (_relay_replies(relay_socket));
+    }
+
+    return true;
+}
+
+Session* UdpRelay::_find_client(const void* sock_addr)
+{
+    UdpEndpoint client(sock_addr);
+    auto found = _clients.find(client);
+
+    if (found != _clients.end())
+        return found->second;
+
+    // first datagram of a client that didn't tell its port
+    uint16_t port = client.port;
+    client.port = 0;
+
+    auto unbound = _unbound.find(client);
+
+    if (unbound == _unbound.end())
+        return nullptr;
+
+    Session* session = unbound->second;
+    _unbound.erase(unbound);
+
+    client.port = port;
+    _clients[client] = session;
+
+    Association& association = _associations.at(session);
+    association.client = client;
+    association.bound = true;
+
+    return session;
+}
+
+UdpRelaySocket* UdpRelay::_route(Session& session, const void* sock_addr)
+{
+    auto association = _associations.find(&session);
+
+    if (association == _associations.end())
+        return nullptr;
+
+    int family = reinterpret_cast<const sockaddr*>(sock_addr)->sa_family;
+    auto& pool = _egress[family == AF_INET ? 0 : 1];
+    UdpEndpoint remote(sock_addr);
+
+    // the egress socket of the association for this host, or the first
+    // one free for it, starting from the preferred one
+    for (size_t i = 0; i < pool.size(); i++)
+    {
+        size_t idx = (association->second.egress + i) % pool.size();
+        remote.socket = static_cast<uint8_t>(idx);
+
+        auto [flow, inserted] = _flows.emplace(remote, &session);
+
+        if (inserted)
+            _add_flow(session, association->second, remote);
+
+        if (flow->second == &session)
+            return pool[idx].get();
+    }
+
+    if (pool.size() >= _server.get_udp_egress_sockets())
+    {
+        LOGD("UDP relay: no egress socket left for this remote host");
+        return nullptr;
+    }
+
+    UdpRelaySocket* egress = _open_egress(family);
+
+    if (!egress)
+        return nullptr;
+
+    remote.socket = egress->get_index();
+    _flows.emplace(remote, &session);
+    _add_flow(session, association->second, remote);
+
+    return egress;
+}
+
+void UdpRelay::_add_flow(
+    Session& session,
+    Association& association,
+    const UdpEndpoint& remote
+) {
+    association.flows.push_back(remote);
+
+    if (association.flows.size() < 2 * _server.get_udp_flow_limit())
+        return;
+
+    // the flow table of the session decides which ones are still in use
+    const UdpFlowTable& table = session.get_udp_flows();
+
+    std::erase_if(association.flows, [&](const UdpEndpoint& flow) {
+        if (table.contains(flow))
+            return false;
+
+        auto found = _flows.find(flow);
+
+        if (found != _flows.end() && found->second == &session)
+            _flows.erase(found);
+
+        return true;
+    });
+}
+
+UdpRelaySocket* UdpRelay::_open_egress(int family)
+{
+    auto& pool = _egress[family == AF_INET ? 0 : 1];
+
+    try {
+        Socket sock = family == AF_INET
+            ? Socket::open_udp()
+            : Socket::open_udp6();
+
+        sock.set_blocking(false);
+
+        pool.push_back(std::make_unique<UdpRelaySocket>(
+            std::move(sock),
+            *this,
+            static_cast<uint8_t>(pool.size())
+        ));
+    } catch (const SocketCreationException& ex) {
+        LOGE("UDP egress socket couldn't be opened (errno: %d)", ex.code());
+        return nullptr;
+    }
+
+    UdpRelaySocket* egress = pool.back().get();
+
+    if (_server.get_udp_offload())
+        egress->enable_udp_offload(true);
+
+    if (!_poller.register_event(Event(
+            egress->get_socket().get_fd(),
+            static_cast<Event::Flags>(Event::Read | Event::Closed | Event::Edge),
+            reinterpret_cast<void*>(egress))))
+    {
+        LOGE("UDP egress socket couldn't be registered (errno: %d)", sockerrno);
+        pool.pop_back();
+        return nullptr;
+    }
+
+    return egress;
+}
+
+void UdpRelay::_reopen(UdpRelaySocket* relay_socket)
+{
+    // the object stays, other events of the batch may still point to it
+    Socket& sock = relay_socket->get_socket();
+    bool is_client = relay_socket == _client_socket.get();
+    int family = AF_INET6;
+
+    if (is_client)
+    {
+        if (IPAddress(_ip, 0).get_version() == IPAddress::Version::IPv4)
+            family = AF_INET;
+    }
+    else if (relay_socket->get_index() < _egress[0].size()
+        && _egress[0][relay_socket->get_index()].get() == relay_socket)
+    {
+        family = AF_INET;
+    }
+
+    _poller.remove_event(sock.get_fd());
+    sock.close();
+
+    try {
+        Socket new_sock = family == AF_INET
+            ? Socket::open_udp()
+            : Socket::open_udp6();
+
+        new_sock.set_blocking(false);
+
+        // the clients were told the port, it is taken again
+        if (is_client)
+            new_sock.bind(_ip, ntohs(_port));
+
+        sock = std::move(new_sock);
+    } catch (const Exception& ex) {
+        LOGE("UDP relay socket couldn't be reopened (errno: %d)", ex.code());
+        return;
+    }
+
+    if (_server.get_udp_offload())
+        relay_socket->enable_udp_offload(!is_client);
+
+    if (!_poller.register_event(Event(
+            sock.get_fd(),
+            static_cast<Event::Flags>(Event::Read | Event::Closed | Event::Edge),
+            reinterpret_cast<void*>(relay_socket))))
+    {
+        LOGE("UDP relay socket couldn't be registered (errno: %d)", sockerrno);
+        sock.close();
+    }
+}
+
+bool UdpRelay::_relay_requests()
+{
+    DatagramBatch& batch = _worker.get_udp_batch();
+    int res = batch.recv_from(_client_socket->get_socket().get_fd());
+
+    if (res == -1)
+    {
+        if ((sockerrno != SOCKSPP_EWOULDBLOCK) && (sockerrno != SOCKSPP_EAGAIN))
+            LOGE("UDP relay receive error (errno: %d)", sockerrno);
+
+        return false;
+    }
+
+    bool more = static_cast<size_t>(res) == batch.get_capacity();
+
+    _worker.count_udp_batch(res);
+
+    // the relayed datagrams are moved to the front, in order,
+    // and sent in runs going through the same egress socket
+    size_t count = 0;
+
+    for (size_t i = 0; i < batch.get_size(); i++)
+    {
+        Session* session = _find_client(batch.get_address(i));
+
+        if (!session || !session->relay_udp_request(batch, i))
+            continue;
+
+        UdpRelaySocket* egress = _route(*session, batch.get_address(i));
+
+        if (!egress)
+            continue;
+
+        if (i != count)
+            batch.swap(i, count);
+
+        _targets[count++] = egress;
+    }
+
+    batch.set_size(count);
+
+    for (size_t begin = 0, end = 0; begin < count; begin = end)
+    {
+        while (end < count && _targets[end] == _targets[begin])
+        {
+            end++;
+        }
+
+        _targets[begin]->send_batch(batch, begin, end);
+    }
+
+    return more;
+}
+
+bool UdpRelay::_relay_replies(UdpRelaySocket* egress)
+{
+    DatagramBatch& batch = _worker.get_udp_batch();
+    int res = batch.recv_from(egress->get_socket().get_fd());
+
+    if (res == -1)
+    {
+        if ((sockerrno != SOCKSPP_EWOULDBLOCK) && (sockerrno != SOCKSPP_EAGAIN))
+            LOGE("UDP relay receive error (errno: %d)", sockerrno);
+
+        return false;
+    }
+
+    bool more = static_cast<size_t>(res) == batch.get_capacity();
+
+    _worker.count_udp_batch(res);
+
+    size_t count = 0;
+
+    for (size_t i = 0; i < batch.get_size(); i++)
+    {
+        auto flow = _flows.find(UdpEndpoint(batch.get_address(i), egress->get_index()));
+
+        if (flow == _flows.end() || !flow->second->relay_udp_reply(batch, i))
+            continue;
+
+        if (i != count)
+            batch.swap(i, count);
+
+        count++;
+    }
+
+    batch.set_size(count);
+
+    if (count)
+        _client_socket->send_batch(batch);
+
+    return more;
+}
+
+} // namespace sockspp::server
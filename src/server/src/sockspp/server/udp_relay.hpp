@@ -0,0 +1,107 @@
+#pragma once
+
+#include "session_socket.hpp"
+#include "udp_flow_table.hpp"
+
+#include <sockspp/core/socket.hpp>
+#include <sockspp/core/datagram_batch.hpp>
+#include <sockspp/core/poller/poller.hpp>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+namespace sockspp::server
+{
+
+class Server;
+class Worker;
+class Session;
+class UdpRelay;
+
+// Socket of a UdpRelay, the events go to the relay
+class UdpRelaySocket : public SessionSocket
+{
+public:
+    UdpRelaySocket(Socket&& sock, UdpRelay& relay, uint8_t index);
+
+    using SessionSocket::get_socket;
+    uint8_t get_index() const;
+
+    bool process_event(Event::Flags event_flags) override;
+
+private:
+    UdpRelay& _relay;
+    uint8_t _index; // in its egress pool
+
+}; // class UdpRelaySocket
+
+// Shared UDP relay of a worker (--udp-shared-port). Every association of
+// the worker gets the same client facing port, and datagrams go out
+// through a pool of egress sockets per address family instead of two
+// sockets per association. Client datagrams are matched to their
+// association by source address, the port being learned from the first
+// datagram when the client didn't announce it. A remote host is reached
+// by each association through an egress socket of its own, so replies
+// are matched by egress socket and source address; the pool grows when
+// several associations talk to the same remote host at once. The remote
+// hosts forgotten by the flow table of an association are let go when
+// it has twice the flow limit of them.
+class UdpRelay
+{
+public:
+    UdpRelay(const Server& server, Worker& worker);
+    UdpRelay(const UdpRelay& other) = delete;
+    ~UdpRelay();
+
+    // binds the client facing socket (port chosen by the system)
+    void open(const std::string& ip);
+    uint16_t get_port() const; // network byte order
+
+    // client: the tcp peer of the session, with the port it announced
+    void attach(Session& session, const SocketInfo& client);
+    void detach(Session& session);
+
+    // one datagram of the session, already translated
+    int send_to(Session& session, MemoryBuffer& buffer, void* addr, int addr_len);
+
+    bool process_event(UdpRelaySocket* relay_socket, Event::Flags event_flags);
+
+private:
+    struct Association
+    {
+        UdpEndpoint client;
+        bool bound; // client port known
+        size_t egress; // preferred egress socket
+        std::vector<UdpEndpoint> flows; // remote hosts, see _flows
+    };
+
+    Session* _find_client(const void* sock_addr);
+    UdpRelaySocket* _route(Session& session, const void* sock_addr);
+    void _add_flow(Session& session, Association& association, const UdpEndpoint& remote);
+    UdpRelaySocket* _open_egress(int family);
+    void _reopen(UdpRelaySocket* relay_socket); // the socket was closed
+    bool _relay_requests(); // true if the batch came back full
+    bool _relay_replies(UdpRelaySocket* egress);
+
+private:
+    const Server& _server;
+    Worker& _worker;
+    Poller& _poller;
+    std::string _ip; // of the client facing socket
+    std::unique_ptr<UdpRelaySocket> _client_socket;
+    std::vector<std::unique_ptr<UdpRelaySocket>> _egress[2]; // IPv4, IPv6
+    std::unordered_map<const Session*, Association> _associations;
+    std::unordered_map<UdpEndpoint, Session*, UdpEndpointHash> _clients;
+    std::unordered_multimap<UdpEndpoint, Session*, UdpEndpointHash> _unbound; // port 0
+    std::unordered_map<UdpEndpoint, Session*, UdpEndpointHash> _flows;
+    std::vector<UdpRelaySocket*> _targets; // egress socket of each batch datagram
+    size_t _next_egress = 0;
+    uint16_t _port = 0;
+
+}; // class UdpRelay
+
+} // namespace sockspp::server
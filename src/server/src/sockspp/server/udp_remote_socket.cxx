@@ -0,0 +1,19 @@
+#include "udp_remote_socket.hpp"
+#include "session.hpp"
+
+namespace sockspp::server
+{
+
+UDPRemoteSocket::UDPRemoteSocket(Socket&& sock)
+    : SessionSocket(std::move(sock))
+{
+    Socket& _sock = this->get_socket();
+    _sock.set_blocking(false);
+}
+
+bool UDPRemoteSocket::process_event(Event::Flags event_flags)
+{
+    return this->get_session().process_udp_remote_event(event_flags);
+}
+
+} // namespace sockspp::server
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "session_socket.hpp"
+
+namespace sockspp::server
+{
+
+// The remote side of a UDP association: datagrams of the client go
+// out of it to their destination as they are, replies come back to it
+class UDPRemoteSocket : public SessionSocket
+{
+public:
+    UDPRemoteSocket(Socket&& sock);
+
+    bool process_event(Event::Flags event_flags) override;
+}; // class UDPRemoteSocket
+
+} // namespace sockspp::server
@@ -3,6 +3,7 @@
 #include "defs.hpp"
 
 #include <sockspp/core/s5.hpp>
+#include <sockspp/core/ip_address.hpp>
 #include <sockspp/core/log.hpp>
 
 #ifdef _WIN32
@@ -28,21 +29,108 @@ bool UDPSocket::process_event(Event::Flags event_flags)
     return this->get_session().process_udp_event(event_flags);
 }
 
-int UDPSocket::recv_from(
-    MemoryBuffer& buffer,
-    void* addr,
-    int* addr_len
-) {
-    int res = SessionSocket::recv_from(buffer, addr, addr_len);
+int UDPSocket::recv_batch(DatagramBatch& batch)
+{
+    int res = SessionSocket::recv_batch(batch);
 
-    if (res <= 10)
-    {
-        LOGD("res <= 10");
+    if (res <= 0)
         return res;
+
+    // the relayed datagrams are moved to the front, in order
+    size_t count = 0;
+
+    for (size_t i = 0; i < batch.get_size(); i++)
+    {
+        if (!translate_request(batch, i))
+            continue;
+
+        if (i != count)
+            batch.swap(i, count);
+
+        count++;
+    }
+
+    batch.set_size(count);
+    return res;
+}
+
+int UDPSocket::send_batch(DatagramBatch& batch)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < batch.get_size(); i++)
+    {
+        if (!translate_reply(batch, i))
+            continue;
+
+        if (i != count)
+            batch.swap(i, count);
+
+        count++;
     }
 
+    batch.set_size(count);
+
+    if (!count)
+        return 0;
+
+    return SessionSocket::send_batch(batch);
+}
+
+size_t UDPSocket::take_domain_destination(const uint8_t* data)
+{
+    S5UDPHeader header(const_cast<uint8_t*>(data));
+    S5Address address = header.get_address();
+    uint8_t* domain_name_data = address.get_address();
+
+    _domain_name.assign(
+        reinterpret_cast<char*>(domain_name_data + 1),
+        *domain_name_data
+    );
+    _domain_port = address.get_port();
+
+    return header.get_size();
+}
+
+const std::string& UDPSocket::get_domain_name() const
+{
+    return _domain_name;
+}
+
+uint16_t UDPSocket::get_domain_port() const
+{
+    return _domain_port;
+}
+
+UdpFragmentQueue& UDPSocket::get_fragments()
+{
+    return _fragments;
+}
+
+UdpFlowTable& UDPSocket::get_flows()
+{
+    return _flows;
+}
+
+const UdpFlowTable& UDPSocket::get_flows() const
+{
+    return _flows;
+}
+
+void UDPSocket::add_flow(const void* remote_addr)
+{
+    _flows.update(remote_addr, _client_port);
+}
+
+bool UDPSocket::translate_request(DatagramBatch& batch, size_t idx)
+{
+    MemoryBuffer data = batch.get_data(idx);
+
+    if (data.get_size() <= 10)
+        return false;
+
     SocketInfo info;
-    info.from(addr);
+    info.from(batch.get_address(idx));
 
     uint16_t port_bkp = _client_info.port;
     _client_info.port = info.port;
@@ -50,104 +138,104 @@ int UDPSocket::recv_from(
     _client_info.port = port_bkp;
 
     if (!is_client)
-    {
-        // drop packet for invalid source ip
-        LOGD("!is_client");
-        return 0;
-    }
-
-    if (!addr || !addr_len)
-        return res;
+        return false;
 
-    S5UDPHeader header(buffer.as<uint8_t*>());
+    S5UDPHeader header(data.get_ptr());
     S5Address remote_address = header.get_address();
     AddrType remote_address_type = remote_address.get_type();
 
-    if (remote_address_type == AddrType::DomainName)
+    if (remote_address_type != AddrType::IPv4
+        && remote_address_type != AddrType::IPv6
+        && remote_address_type != AddrType::DomainName)
     {
-        // sorry, we don't support it for udp... yet
-        LOGD("remote_address_type == AddrType::DomainName");
-        return 0;
+        return false;
     }
 
-    sockaddr_storage remote_addr;
-    socklen_t remote_addr_len = sizeof(remote_addr);
+    size_t header_size = header.get_size();
 
-    if (remote_address_type == AddrType::IPv4)
-    {
-        remote_addr.ss_family = AF_INET;
-        sockaddr_in* s = reinterpret_cast<sockaddr_in*>(&remote_addr);
-        s->sin_addr.s_addr =
-            *reinterpret_cast<uint32_t*>(remote_address.get_address());
-        s->sin_port = htons(remote_address.get_port());
-    }
-    else if (remote_address_type == AddrType::IPv6)
+    if (header_size > data.get_size())
+        return false;
+
+    if (header.get_frag())
     {
-        remote_addr.ss_family = AF_INET6;
-        sockaddr_in6* s =
-            reinterpret_cast<sockaddr_in6*>(&remote_addr);
-        s->sin6_port = htons(remote_address.get_port());
-        memcpy(&s->sin6_addr, remote_address.get_address(), sizeof(s->sin6_addr));
+        size_t size = _fragments.add(
+            data.as<uint8_t*>(),
+            data.get_size(),
+            header_size,
+            data.get_capacity()
+        );
+
+        if (!size)
+            return false;
+
+        // relayed like a datagram that wasn't fragmented
+        batch.set_data(idx, data.as<uint8_t*>(), size);
+        return translate_request(batch, idx);
     }
-    else
+
+    _client_port = info.port;
+
+    if (remote_address_type == AddrType::DomainName)
     {
-        // we don't support other address types too
-        return 0;
+        // left for the session with the header, see take_domain_destination
+        batch.set_address_length(idx, 0);
+        return true;
     }
 
-    int new_sock_addr_len = 
-        *addr_len < remote_addr_len
-            ? *addr_len
-            : remote_addr_len;
-
-    memcpy(
-        addr,
-        &remote_addr,
-        new_sock_addr_len
+    IPAddress remote(
+        remote_address_type == AddrType::IPv4
+            ? IPAddress::Version::IPv4
+            : IPAddress::Version::IPv6,
+        remote_address.get_address(),
+        remote_address.get_port(),
+        false
     );
 
-    *addr_len = new_sock_addr_len;
-    _port_maps[htons(remote_address.get_port())] = info.port;
-
-    int header_size = header.get_size();
-    int buffer_size = buffer.get_size() - header_size;
-    memcpy(buffer.get_ptr(), buffer.as<uint8_t*>() + header_size, buffer_size);
-    buffer.set_size(buffer_size);
+    batch.set_address_length(idx, remote.to_sockaddr(batch.get_address(idx)));
+    _flows.update(batch.get_address(idx), info.port);
+    batch.set_data(
+        idx,
+        data.as<uint8_t*>() + header_size,
+        data.get_size() - header_size
+    );
 
     LOG_SCOPE(LogLevel::Debug)
     {
         SocketInfo remote_info;
-        remote_info.from(&remote_addr);
+        remote_info.from(batch.get_address(idx));
 
         LOGD("UDP | %s -> %s | %zu",
             info.str().c_str(),
             remote_info.str().c_str(),
-            buffer.get_size()
+            data.get_size() - header_size
         );
     }
 
-    return buffer_size;
+    return true;
 }
 
-int UDPSocket::send_to(
-    MemoryBuffer& buffer,
-    void* addr,
-    int addr_len
-) {
+bool UDPSocket::translate_reply(DatagramBatch& batch, size_t idx)
+{
+    uint16_t client_port = _flows.lookup(batch.get_address(idx));
+
     SocketInfo remote_info;
-    remote_info.from(addr);
-    if (!_port_maps.contains(remote_info.port))
+    remote_info.from(batch.get_address(idx));
+
+    if (!client_port)
     {
-        LOGE("UDP Remote port wasn't mapped");
-        return 0;
+        LOGD("UDP | %s | unknown remote host", remote_info.str().c_str());
+        return false;
     }
 
-    // prepare header
-    uint8_t _header[SOCKSPP_SESSION_SOCKET_BUFFER_SIZE + 22];
-    _header[0] = 0;
-    _header[1] = 0;
-    _header[2] = 0;
-    S5UDPHeader header(_header);
+    // the header goes in the headroom in front of the payload
+    MemoryBuffer data = batch.get_data(idx);
+    size_t header_size = remote_info.ip_version == SocketInfo::IPv4 ? 10 : 22;
+    uint8_t* packet = data.as<uint8_t*>() - header_size;
+
+    packet[0] = 0;
+    packet[1] = 0;
+    packet[2] = 0;
+    S5UDPHeader header(packet);
     S5Address address = header.get_address();
     address.set_type(
         remote_info.ip_version == SocketInfo::IPv4
@@ -157,61 +245,26 @@ int UDPSocket::send_to(
     address.set_address(remote_info.ip);
     address.set_port(remote_info.port, true);
 
-    memcpy(
-        reinterpret_cast<uint8_t*>(_header) + header.get_size(),
-        buffer.as<uint8_t*>(),
-        buffer.get_size()
-    );
-
-    MemoryBuffer send_buffer(
-        _header,
-        header.get_size() + buffer.get_size(),
-        SOCKSPP_SESSION_SOCKET_BUFFER_SIZE + 22
-    );
-
-    sockaddr_storage send_addr;
-    socklen_t send_addr_len;
+    batch.set_data(idx, packet, header_size + data.get_size());
 
-    if (_client_info.ip_version == SocketInfo::IPv4)
-    {
-        send_addr.ss_family = AF_INET;
-        sockaddr_in* s = reinterpret_cast<sockaddr_in*>(&send_addr);
-        s->sin_addr.s_addr =
-            *reinterpret_cast<uint32_t*>(_client_info.ip);
-        s->sin_port = _port_maps[remote_info.port];
-        send_addr_len = sizeof(sockaddr_in);
-    }
-    else
-    {
-        send_addr.ss_family = AF_INET6;
-        sockaddr_in6* s =
-            reinterpret_cast<sockaddr_in6*>(&send_addr);
-        s->sin6_port = _port_maps[remote_info.port];
-        memcpy(&s->sin6_addr, _client_info.ip, sizeof(s->sin6_addr));
-        send_addr_len = sizeof(sockaddr_in6);
-    }
+    // coalesced replies (GRO) get the header in front of each one
+    if (batch.get_segment_size(idx))
+        batch.set_prefix_size(idx, header_size);
 
-    int res = SessionSocket::send_to(send_buffer, &send_addr, send_addr_len);
+    SocketInfo client_info = _client_info;
+    client_info.port = client_port;
+    int addr_len = 0;
+    memset(batch.get_address(idx), 0, sizeof(sockaddr_in6));
+    client_info.to(batch.get_address(idx), &addr_len);
+    batch.set_address_length(idx, addr_len);
 
-    if (res <= 0)
-    {
-        LOGE("UDP send_to res: %d", res);
-        return res;
-    }
-
-    LOG_SCOPE(LogLevel::Debug)
-    {
-        SocketInfo client_info;
-        client_info.from(&send_addr);
-
-        LOGD("UDP | %s <- %s | %zu",
-            client_info.str().c_str(),
-            remote_info.str().c_str(),
-            send_buffer.get_size()
-        );
-    }
+    LOGD("UDP | %s <- %s | %zu",
+        client_info.str().c_str(),
+        remote_info.str().c_str(),
+        header_size + data.get_size()
+    );
 
-    return buffer.get_size();
+    return true;
 }
 
 } // namespace sockspp::server
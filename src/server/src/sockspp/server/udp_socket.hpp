@@ -2,8 +2,10 @@
 
 #include <sockspp/core/memory_buffer.hpp>
 #include <sockspp/server/session_socket.hpp>
+#include <sockspp/server/udp_flow_table.hpp>
+#include <sockspp/server/udp_reassembly.hpp>
 
-#include <unordered_map>
+#include <string>
 #include <cstdint>
 
 namespace sockspp::server
@@ -16,12 +18,43 @@ public:
 
     bool process_event(Event::Flags event_flags) override;
 
-    int recv_from(MemoryBuffer& buffer, void* addr, int* addr_len) override;
-    int send_to(MemoryBuffer& buffer, void* addr, int addr_len) override;
+    // datagrams of the client: the header is skipped and the address
+    // becomes the destination, the ones from another host are dropped,
+    // the ones sent to a domain name keep their header and get an empty
+    // address (see take_domain_destination). Returns the number of
+    // datagrams received, the batch keeps the ones to relay
+    int recv_batch(DatagramBatch& batch) override;
+    // replies of the remote hosts, sent to the client with a header
+    int send_batch(DatagramBatch& batch) override;
+
+    // one datagram of a batch, false if it's dropped (see recv_batch,
+    // send_batch), used as is by the shared relay. A fragment is kept
+    // until its datagram is complete, which then takes its place
+    bool translate_request(DatagramBatch& batch, size_t idx);
+    bool translate_reply(DatagramBatch& batch, size_t idx);
+
+    // reads the domain name of a socks udp header, returns its size
+    size_t take_domain_destination(const uint8_t* data);
+    const std::string& get_domain_name() const;
+    uint16_t get_domain_port() const;
+
+    // remote hosts and the client port of each one
+    UdpFlowTable& get_flows();
+    const UdpFlowTable& get_flows() const;
+    // the remote host a domain datagram went to, replies go to
+    // the client port of the last datagram
+    void add_flow(const void* remote_addr);
+
+    // fragmented datagrams of the client, see translate_request
+    UdpFragmentQueue& get_fragments();
 
 private:
-    std::unordered_map<uint16_t, uint16_t> _port_maps;
+    UdpFlowTable _flows;
+    UdpFragmentQueue _fragments;
     SocketInfo _client_info;
+    uint16_t _client_port = 0; // of the last datagram, network byte order
+    std::string _domain_name; // destination of the last datagram
+    uint16_t _domain_port = 0;
 
 }; // class UDPSocket
 
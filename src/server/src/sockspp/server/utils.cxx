@@ -1,6 +1,8 @@
 #include "utils.hpp"
 
 #include <string>
+#include <algorithm>
+#include <cctype>
 
 #if defined _WIN32
     #include <ws2tcpip.h>
@@ -116,10 +118,17 @@ std::vector<std::string> get_dns_nameservers()
 
     while (std::getline(resolv_file, line))
     {
-        if (line.starts_with("nameserver "))
-        {
-            nameservers.push_back(line.substr(11));
-        }
+        if (!line.starts_with("nameserver"))
+            continue;
+
+        // "nameserver <address>", maybe followed by a comment
+        size_t start = line.find_first_not_of(" \t", 10);
+
+        if (start == std::string::npos || start == 10)
+            continue;
+
+        size_t end = line.find_first_of(" \t#;", start);
+        nameservers.push_back(line.substr(start, end - start));
     }
 
     return nameservers;
@@ -134,4 +143,18 @@ std::vector<std::string> get_dns_nameservers()
 
 #endif
 
+std::string normalize_domain_name(const std::string& name)
+{
+    std::string result(name);
+
+    std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) {
+        return std::tolower(c);
+    });
+
+    if (!result.empty() && result.back() == '.')
+        result.pop_back();
+
+    return result;
+}
+
 } // namespace sockspp::server
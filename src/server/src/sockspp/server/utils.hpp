@@ -8,4 +8,7 @@ namespace sockspp::server
 
 std::vector<std::string> get_dns_nameservers();
 
+// lower case, without the trailing dot
+std::string normalize_domain_name(const std::string& name);
+
 } // namespace sockspp::server
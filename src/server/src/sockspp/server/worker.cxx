@@ -0,0 +1,627 @@
+#include "worker.hpp"
+#include "server.hpp"
+#include "session.hpp"
+#include "session_socket.hpp"
+#include "defs.hpp"
+
+#include <sockspp/core/poller/poller.hpp>
+#include <sockspp/core/poller/event.hpp>
+#include <sockspp/core/log.hpp>
+#include <sockspp/core/errno.hpp>
+
+#include <vector>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+#else
+    #include <netinet/in.h>
+#endif
+
+#if defined(_WIN32)
+    #define SOCKSPP_POLL_TIMEOUT 2000
+#else
+    #define SOCKSPP_POLL_TIMEOUT -1
+#endif // _WIN32
+
+namespace sockspp::server
+{
+
+static bool _is_out_of_resources(int error)
+{
+    return error == SOCKSPP_EMFILE
+        || error == SOCKSPP_ENFILE
+        || error == SOCKSPP_ENOBUFS
+        || error == ENOMEM;
+}
+
+Worker::Worker(Server& server, int id, size_t max_sessions)
+    : _server(server)
+    , _timers(SOCKSPP_WORKER_TIMER_TICK)
+    , _server_socket(-1)
+    , _listen_fd(-1)
+    , _pool(max_sessions ? max_sessions : SOCKSPP_WORKER_INITIAL_POOL_SIZE)
+    , _resolver(server, _poller, _timers)
+    , _hosts_version(0)
+    , _udp_batch(
+        server.get_udp_batch_size(),
+        SOCKSPP_SESSION_UDP_DATAGRAM_SIZE,
+        SOCKSPP_SESSION_UDP_HEADROOM
+    )
+    , _udp_reassembly(server.get_udp_reassembly_size())
+    , _max_sessions(max_sessions)
+    , _id(id)
+{
+    _sessions.reserve(
+        max_sessions ? max_sessions : SOCKSPP_WORKER_INITIAL_POOL_SIZE
+    );
+    _closed_sessions.reserve(SOCKSPP_SERVER_INITIAL_POLL_RESULT_SIZE);
+
+    _accept_timer.set_callback([this]() {
+        _accept_paused = false;
+
+        if (!_register_listener())
+        {
+            LOGE("Worker %d: couldn't register server event", _id);
+            _server.stop();
+        }
+    });
+}
+
+Worker::~Worker()
+{
+    _delete_all_sessions();
+}
+
+void Worker::listen(bool reuse_port)
+{
+    _server_socket = Socket::open_tcp();
+    _server_socket.set_blocking(false);
+
+    if (reuse_port && !_server_socket.set_reuseport(true))
+    {
+        LOGW("Worker %d: couldn't enable SO_REUSEPORT", _id);
+    }
+
+    _server_socket.bind(_server.get_listen_ip(), _server.get_listen_port());
+    _server_socket.listen(static_cast<int>(_server.get_listen_backlog()));
+
+    unsigned int defer_accept = _server.get_tcp_defer_accept();
+
+    if (defer_accept && !_server_socket.set_defer_accept(defer_accept))
+    {
+        LOGW("Worker %d: couldn't enable TCP_DEFER_ACCEPT", _id);
+    }
+
+    if (_server.get_udp_shared_port())
+    {
+        _udp_relay = std::make_unique<UdpRelay>(_server, *this);
+        _udp_relay->open(_server.get_listen_ip());
+
+        LOGI("Worker %d: udp relay on port %u", _id, ntohs(_udp_relay->get_port()));
+    }
+
+    _listen_fd = _server_socket.get_fd();
+}
+
+void Worker::run()
+{
+    int server_sock = _server_socket.get_fd();
+
+    if (!_register_listener())
+    {
+        LOGE("Worker %d: couldn't register server event", _id);
+        _server.stop();
+        return;
+    }
+
+    std::vector<Event> events;
+    events.reserve(SOCKSPP_SERVER_INITIAL_POLL_RESULT_SIZE);
+
+    // the cache is shared, one worker takes care of its snapshots
+    unsigned int save_interval = _server.get_dns_cache_save_interval();
+
+    if (_id == 0 && save_interval)
+    {
+        _dns_cache_timer.set_callback([this, save_interval]() {
+            _server.save_dns_cache();
+            _timers.arm(_dns_cache_timer, save_interval * 1000ull);
+        });
+
+        _timers.arm(_dns_cache_timer, save_interval * 1000ull);
+    }
+
+    if (_id == 0 && _server.has_hosts_files())
+    {
+        _hosts_timer.set_callback([this]() {
+            _server.reload_hosts();
+            _timers.arm(_hosts_timer, SOCKSPP_HOSTS_CHECK_INTERVAL);
+        });
+
+        _timers.arm(_hosts_timer, SOCKSPP_HOSTS_CHECK_INTERVAL);
+    }
+
+    while (_server.is_serving())
+    {
+        events.clear();
+
+        // sleep until the next timer is due, on Windows wake up
+        // periodically anyway because it does not trigger EINTR
+        int timeout = _timers.get_timeout();
+
+        if (SOCKSPP_POLL_TIMEOUT != -1
+            && (timeout == -1 || timeout > SOCKSPP_POLL_TIMEOUT))
+        {
+            timeout = SOCKSPP_POLL_TIMEOUT;
+        }
+
+        int res = _poller.poll(events, timeout);
+
+        if (res == -1)
+        {
+            if (sockerrno != EINTR)
+            {
+                LOGE("Worker %d: poll error: %d", _id, sockerrno);
+                _server.stop();
+                break;
+            }
+
+            // interrupted, the loop condition decides whether we stop
+            continue;
+        }
+
+        // fire expired timers first, it also refreshes the loop
+        // time that sessions use to track their activity
+        _timers.advance();
+
+        for (size_t i = 0; i < events.size(); i++)
+        {
+            Event& event = events[i];
+            Event::Flags flags = event.get_flags();
+
+            // server
+            if (event.get_ptr() == reinterpret_cast<void*>(this))
+            {
+                if (!_server.is_serving())
+                {
+                    // woken up by Server::stop()
+                    break;
+                }
+
+                if (flags & Event::Accepted)
+                {
+                    _accept_client(event.get_result());
+                }
+                else if (flags & Event::Read)
+                {
+                    _accept_clients();
+                }
+                else
+                {
+                    LOGE("Worker %d: server error", _id);
+                    _server.stop();
+                    break;
+                }
+            }
+
+            // session
+            else if (event.get_ptr())
+            {
+                SessionSocket* session_socket = \
+                    reinterpret_cast<SessionSocket*>(event.get_ptr());
+
+                if (!session_socket->has_session())
+                {
+                    // dns query or shared udp relay, the resolver
+                    // and the relay clean up after themselves
+                    session_socket->process_event(flags);
+                    continue;
+                }
+
+                Session* session = &session_socket->get_session();
+
+#if SOCKSPP_POLLER_COMPLETIONS
+                // closed sessions get them too, the poller may still
+                // be sending from their buffers
+                if (flags & (Event::Received | Event::Sent))
+                {
+                    if (!session->process_completion(session_socket, event))
+                        close_session(session);
+
+                    continue;
+                }
+#endif
+
+                // closed sessions stay allocated until the end of the
+                // batch, so their remaining events are simply skipped
+                if (session->is_closed())
+                {
+                    continue;
+                }
+
+                if (!session_socket->process_event(flags))
+                {
+                    // delete session when socket is closed
+                    close_session(session);
+                }
+            }
+        }
+
+        if (!_closed_sessions.empty())
+        {
+            size_t closed = _closed_sessions.size();
+            _reclaim_sessions();
+
+            if (_closed_sessions.size() != closed)
+                _log_sessions();
+        }
+
+        _resolver.reclaim_sockets();
+    }
+
+    if (_accept_paused)
+        _accept_timer.cancel();
+    else
+        _poller.remove_event(server_sock);
+
+    _delete_all_sessions();
+}
+
+void Worker::stop()
+{
+    // shutting the listening socket down wakes the poller
+    // of this worker even if it's blocked in another thread,
+    // the socket itself is only closed after the threads joined
+    int fd = _listen_fd;
+
+    if (fd == -1)
+        return;
+
+    Socket listener(fd);
+    listener.shutdown();
+    listener.detach();
+}
+
+void Worker::close()
+{
+    _listen_fd = -1;
+    _server_socket.close();
+}
+
+int Worker::get_id() const
+{
+    return _id;
+}
+
+Poller& Worker::get_poller()
+{
+    return _poller;
+}
+
+SessionPool& Worker::get_pool()
+{
+    return _pool;
+}
+
+TimerWheel& Worker::get_timers()
+{
+    return _timers;
+}
+
+Resolver& Worker::get_resolver()
+{
+    return _resolver;
+}
+
+const HostTable& Worker::get_hosts()
+{
+    // the shared table is only fetched again after a reload
+    uint64_t version = _server.get_hosts_version();
+
+    if (version != _hosts_version)
+    {
+        _hosts = _server.get_hosts();
+        _hosts_version = version;
+    }
+
+    return *_hosts;
+}
+
+size_t Worker::get_session_count() const
+{
+    return _sessions.size();
+}
+
+DatagramBatch& Worker::get_udp_batch()
+{
+    return _udp_batch;
+}
+
+UdpRelay* Worker::get_udp_relay()
+{
+    return _udp_relay.get();
+}
+
+UdpFlowTable::Stats& Worker::get_udp_flow_stats()
+{
+    return _udp_flow_stats;
+}
+
+UdpReassembly& Worker::get_udp_reassembly()
+{
+    return _udp_reassembly;
+}
+
+void Worker::count_udp_batch(size_t size)
+{
+    if (!size)
+        return;
+
+    _udp_batches++;
+    _udp_datagrams += size;
+
+    if (size == _udp_batch.get_capacity())
+        _udp_full_batches++;
+}
+
+bool Worker::_register_listener()
+{
+    // io_uring accepts on its own unless hooks want to
+    bool multishot = _poller.has_completions()
+        && _server.get_hook()->can_accept_multishot();
+
+    Event server_event(
+        _server_socket.get_fd(),
+        multishot ? Event::Accepted : Event::Read,
+        reinterpret_cast<void*>(this)
+    );
+
+    return _poller.register_event(server_event);
+}
+
+void Worker::_accept_clients()
+{
+    // drains the accept queue, a batch at a time so sessions
+    // of this worker still get their turn during a storm
+    size_t batch_size = _server.get_accept_batch_size();
+
+    for (size_t i = 0; i < batch_size; i++)
+    {
+        Socket client(-1);
+
+        if (_server.get_hook()->client_accept(_server_socket, client) == -1)
+        {
+            if ((sockerrno == SOCKSPP_EWOULDBLOCK) || (sockerrno == SOCKSPP_EAGAIN))
+                break;
+
+            // gone before it was accepted
+            if ((sockerrno == SOCKSPP_ECONNABORTED) || (sockerrno == EINTR))
+                continue;
+
+            if (_is_out_of_resources(sockerrno))
+            {
+                _pause_accept(sockerrno);
+                break;
+            }
+
+            LOGE("Worker %d: accept failed (%d)", _id, sockerrno);
+            break;
+        }
+
+        _add_client(std::move(client));
+    }
+}
+
+void Worker::_accept_client(int fd)
+{
+    if (fd < 0)
+    {
+        // gone before it was accepted
+        if ((-fd == SOCKSPP_ECONNABORTED) || (-fd == EINTR))
+            return;
+
+        // the multishot accept keeps completing with the same error
+        if (_is_out_of_resources(-fd))
+        {
+            _pause_accept(-fd);
+            return;
+        }
+
+        LOGE("Worker %d: accept failed (%d)", _id, -fd);
+        return;
+    }
+
+    _add_client(Socket(fd));
+}
+
+void Worker::_pause_accept(int error)
+{
+    // a connection waiting in the queue keeps the listener readable,
+    // so the listener leaves the poller instead of failing every loop
+    if (_accept_paused)
+        return;
+
+    _poller.remove_event(_server_socket.get_fd());
+    _accept_paused = true;
+    _timers.arm(_accept_timer, SOCKSPP_WORKER_ACCEPT_BACKOFF);
+
+    uint64_t now = _timers.get_time();
+    _accept_errors++;
+
+    if (_accept_error_time
+        && now - _accept_error_time < SOCKSPP_WORKER_ACCEPT_LOG_INTERVAL)
+    {
+        return;
+    }
+
+    LOGE(
+        "Worker %d: accept failed %zu times (errno: %d), "
+        "pausing accepts for %d ms",
+        _id,
+        _accept_errors,
+        error,
+        SOCKSPP_WORKER_ACCEPT_BACKOFF
+    );
+
+    _accept_error_time = now;
+    _accept_errors = 0;
+}
+
+void Worker::_add_client(Socket&& client)
+{
+    if (_max_sessions && _sessions.size() >= _max_sessions)
+    {
+        LOGW(
+            "Worker %d: session limit reached (%zu), "
+            "dropping client",
+            _id,
+            _max_sessions
+        );
+        client.close();
+        return;
+    }
+
+    _create_new_session(std::move(client));
+}
+
+Session* Worker::_create_new_session(Socket&& sock)
+{
+    Session* session = _pool.create<Session>(_server, *this, std::move(sock));
+    session->_slot = _sessions.size();
+    _sessions.push_back(session);
+    session->initialize();
+    return session;
+}
+
+void Worker::close_session(Session* session)
+{
+    if (session->is_closed())
+        return;
+
+    session->shutdown();
+
+    // move the last session into the freed slot
+    Session* last = _sessions.back();
+    last->_slot = session->_slot;
+    _sessions[session->_slot] = last;
+    _sessions.pop_back();
+
+    _closed_sessions.push_back(session);
+}
+
+void Worker::_reclaim_sessions()
+{
+    size_t kept = 0;
+
+    for (auto session : _closed_sessions)
+    {
+        // the poller still sends from its buffers
+        if (session->has_pending_io())
+        {
+            _closed_sessions[kept++] = session;
+            continue;
+        }
+
+        _pool.destroy(session);
+    }
+
+    _closed_sessions.resize(kept);
+}
+
+void Worker::_delete_all_sessions()
+{
+    // the poller is not waited for anymore, sends of closed
+    // sessions are canceled with it
+    for (auto session : _closed_sessions)
+    {
+        _pool.destroy(session);
+    }
+
+    _closed_sessions.clear();
+
+    for (auto session : _sessions)
+    {
+        _pool.destroy(session);
+    }
+
+    _sessions.clear();
+}
+
+void Worker::_log_sessions() const
+{
+    // Print active sessions
+    LOG_SCOPE(LOG_LEVEL_DEBUG)
+    {
+        int udp = 0;
+        int tcp = 0;
+        int dns = 0;
+        int conn = 0;
+        int other = 0;
+
+        for (auto session : _sessions)
+        {
+            Session::State state = session->get_state();
+
+            switch (state)
+            {
+                case Session::State::Associated:
+                    udp++;
+                    break;
+                case Session::State::Connected:
+                    tcp++;
+                    break;
+                case Session::State::ResolvingDomainName:
+                    dns++;
+                    break;
+                case Session::State::ConnectingRemote:
+                    conn++;
+                    break;
+                default:
+                    other++;
+                    break;
+            }
+        }
+
+        LOGD(
+            "Worker %d session count: %zu (udp: %d, tcp: %d, dns: %d, con: "
+            "%d, other: %d)",
+            _id,
+            _sessions.size(),
+            udp, tcp, dns, conn, other
+        );
+
+        if (_udp_batches)
+        {
+            LOGD(
+                "Worker %d udp batches: %llu, %.1f of %zu datagrams on average, "
+                "%llu full",
+                _id,
+                static_cast<unsigned long long>(_udp_batches),
+                static_cast<double>(_udp_datagrams) / _udp_batches,
+                _udp_batch.get_capacity(),
+                static_cast<unsigned long long>(_udp_full_batches)
+            );
+        }
+
+        if (_udp_flow_stats.expired || _udp_flow_stats.evicted)
+        {
+            LOGD(
+                "Worker %d udp flows: %llu expired, %llu evicted",
+                _id,
+                static_cast<unsigned long long>(_udp_flow_stats.expired),
+                static_cast<unsigned long long>(_udp_flow_stats.evicted)
+            );
+        }
+
+        if (_udp_reassembly.get_size() || _udp_reassembly.get_dropped())
+        {
+            LOGD(
+                "Worker %d udp reassembly: %zu bytes held, %llu sequences dropped",
+                _id,
+                _udp_reassembly.get_size(),
+                static_cast<unsigned long long>(_udp_reassembly.get_dropped())
+            );
+        }
+    }
+}
+
+} // namespace sockspp::server
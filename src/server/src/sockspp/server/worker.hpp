@@ -0,0 +1,97 @@
+#pragma once
+
+#include "session.hpp"
+#include "session_pool.hpp"
+#include "resolver.hpp"
+#include "host_table.hpp"
+#include "udp_relay.hpp"
+
+#include <sockspp/core/socket.hpp>
+#include <sockspp/core/poller/poller.hpp>
+#include <sockspp/core/timer_wheel.hpp>
+#include <sockspp/core/datagram_batch.hpp>
+
+#include <vector>
+#include <memory>
+#include <atomic>
+
+namespace sockspp::server
+{
+
+class Server;
+
+// Single event loop. Every worker owns its own poller, its own
+// listening socket (SO_REUSEPORT when there is more than one worker)
+// and its own sessions, so nothing is shared on the relay path.
+class Worker
+{
+public:
+    Worker(Server& server, int id, size_t max_sessions);
+    Worker(const Worker& other) = delete;
+    ~Worker();
+
+    void listen(bool reuse_port);
+    void run();
+    void stop(); // can be called from any thread
+    void close(); // once run() returned in every thread
+
+    int get_id() const;
+    Poller& get_poller();
+    SessionPool& get_pool();
+    TimerWheel& get_timers();
+    Resolver& get_resolver();
+    const HostTable& get_hosts(); // latest table of the server
+    size_t get_session_count() const;
+
+    // shared by the udp associations, only used during one event
+    DatagramBatch& get_udp_batch();
+    void count_udp_batch(size_t size); // utilization counters
+    UdpRelay* get_udp_relay(); // nullptr unless --udp-shared-port
+    UdpFlowTable::Stats& get_udp_flow_stats(); // of every association
+    UdpReassembly& get_udp_reassembly();
+
+    // shuts the session down, it is destroyed after the current poll batch
+    void close_session(Session* session);
+
+private:
+    bool _register_listener();
+    void _accept_clients();
+    void _accept_client(int fd); // completion of a multishot accept
+    void _pause_accept(int error); // out of descriptors or memory
+    void _add_client(Socket&& client);
+    Session* _create_new_session(Socket&& sock);
+    void _reclaim_sessions();
+    void _delete_all_sessions();
+    void _log_sessions() const;
+
+private:
+    Server& _server;
+    Poller _poller;
+    TimerWheel _timers;
+    Socket _server_socket;
+    std::atomic<int> _listen_fd; // what stop() shuts down, -1 once closed
+    Timer _accept_timer; // registers the listener again after a pause
+    bool _accept_paused = false;
+    uint64_t _accept_error_time = 0; // of the last reported failure, 0 = none
+    size_t _accept_errors = 0; // failures since then
+    SessionPool _pool;
+    Resolver _resolver;
+    Timer _dns_cache_timer; // periodic snapshot, first worker only
+    Timer _hosts_timer;     // checks the hosts files, first worker only
+    std::shared_ptr<const HostTable> _hosts;
+    uint64_t _hosts_version;
+    DatagramBatch _udp_batch;
+    uint64_t _udp_batches = 0;      // receptions that returned datagrams
+    uint64_t _udp_datagrams = 0;    // datagrams returned by them
+    uint64_t _udp_full_batches = 0; // receptions that filled the batch
+    UdpFlowTable::Stats _udp_flow_stats;
+    UdpReassembly _udp_reassembly;
+    std::unique_ptr<UdpRelay> _udp_relay;
+    std::vector<Session*> _sessions;        // live sessions, see Session::_slot
+    std::vector<Session*> _closed_sessions; // destroyed after the poll batch
+    size_t _max_sessions; // 0 = unlimited
+    int _id;
+
+}; // class Worker
+
+} // namespace sockspp::server
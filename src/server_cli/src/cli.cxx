@@ -81,6 +81,26 @@ static inline sockspp::server::ServerParams parse_params(int argc, char* argv[])
         .scan<'d', uint16_t>()
         .nargs(1);
 
+    parser.add_argument("--listen-backlog")
+        .help("length of the accept queue of each listener (capped by net.core.somaxconn)")
+        .default_value((unsigned int)1024)
+        .scan<'u', unsigned int>()
+        .nargs(1);
+
+    parser.add_argument("--accept-batch-size")
+        .help("connections accepted per wakeup of a listener")
+        .default_value((size_t)64)
+        .scan<'u', size_t>()
+        .nargs(1);
+
+    parser.add_argument("--tcp-defer-accept")
+        .help(
+            "seconds a connection may wait in the kernel for the client greeting\n"
+            "before it is accepted (TCP_DEFER_ACCEPT, Linux), 0 = off")
+        .default_value((unsigned int)0)
+        .scan<'u', unsigned int>()
+        .nargs(1);
+
     parser.add_argument("--username")
         .help("authentication username")
         .default_value("")
@@ -95,6 +115,7 @@ static inline sockspp::server::ServerParams parse_params(int argc, char* argv[])
         .help(
             "dns server ip\n"
             "\"x.x.x.x\" = custom dns server\n"
+            "\"x.x.x.x,y.y.y.y\" = dns servers, in order of preference\n"
             "\"none\" = disable dns resolution\n"
             "\"auto\" = default OS dns server address")
         .default_value("auto")
@@ -107,6 +128,56 @@ static inline sockspp::server::ServerParams parse_params(int argc, char* argv[])
         .scan<'d', uint16_t>()
         .nargs(1);
 
+    parser.add_argument("--dns-cache-size")
+        .help("max number of cached domain names (0 = no cache)")
+        .default_value((size_t)4096)
+        .scan<'u', size_t>()
+        .nargs(1);
+
+    parser.add_argument("--dns-negative-ttl")
+        .help("max seconds to cache a failed name resolution")
+        .default_value((unsigned int)30)
+        .scan<'u', unsigned int>()
+        .nargs(1);
+
+    parser.add_argument("--dns-cache-file")
+        .help("file the dns cache is saved to and loaded from on startup")
+        .default_value("")
+        .nargs(1);
+
+    parser.add_argument("--dns-cache-save-interval")
+        .help("seconds between dns cache snapshots (0 = on shutdown only)")
+        .default_value((unsigned int)300)
+        .scan<'u', unsigned int>()
+        .nargs(1);
+
+    parser.add_argument("--dns-refresh-hits")
+        .help("cache hits in the last 20% of its ttl after which a name is resolved again before it expires (0 = never)")
+        .default_value((unsigned int)8)
+        .scan<'u', unsigned int>()
+        .nargs(1);
+
+    parser.add_argument("--dns-refresh-rate")
+        .help("max number of such refreshes per second")
+        .default_value((unsigned int)20)
+        .scan<'u', unsigned int>()
+        .nargs(1);
+
+    parser.add_argument("--dns-udp-payload-size")
+        .help("udp payload size advertised to the dns server (EDNS0), 0 = no EDNS")
+        .default_value((uint16_t)1232)
+        .scan<'u', uint16_t>()
+        .nargs(1);
+
+    parser.add_argument("--hosts-file")
+        .help("file of static names (hosts format), consulted before /etc/hosts and dns")
+        .default_value("")
+        .nargs(1);
+
+    parser.add_argument("--no-system-hosts")
+        .help("don't consult /etc/hosts")
+        .flag();
+
     parser.add_argument("--client-tcp-nodelay")
         .help("enable tcp nodelay for client socket")
         .flag();
@@ -123,6 +194,120 @@ static inline sockspp::server::ServerParams parse_params(int argc, char* argv[])
         .help("enable tcp keepalive for remote socket")
         .flag();
 
+    parser.add_argument("--splice")
+        .help("relay established tcp connections with zero-copy splice() (Linux only)")
+        .flag();
+
+    parser.add_argument("--relay-buffer-size")
+        .help("size of the buffer holding data not yet sent, per direction (bytes)")
+        .default_value((size_t)262144)
+        .scan<'u', size_t>()
+        .nargs(1);
+
+    parser.add_argument("--relay-high-watermark")
+        .help("stop reading from a socket when this many bytes are pending for the other side")
+        .default_value((size_t)196608)
+        .scan<'u', size_t>()
+        .nargs(1);
+
+    parser.add_argument("--relay-low-watermark")
+        .help("resume reading once pending bytes drop to this value")
+        .default_value((size_t)65536)
+        .scan<'u', size_t>()
+        .nargs(1);
+
+    parser.add_argument("--udp-batch-size")
+        .help("udp datagrams relayed per system call (recvmmsg/sendmmsg)")
+        .default_value((size_t)32)
+        .scan<'u', size_t>()
+        .nargs(1);
+
+    parser.add_argument("--no-udp-offload")
+        .help("don't use udp segmentation/receive offload (UDP_SEGMENT/UDP_GRO)")
+        .flag();
+
+    parser.add_argument("--udp-shared-port")
+        .help("relay the udp associations of a worker through one port and a pool of egress sockets")
+        .flag();
+
+    parser.add_argument("--udp-egress-sockets")
+        .help("most egress sockets per address family and worker with --udp-shared-port")
+        .default_value((size_t)64)
+        .scan<'u', size_t>()
+        .nargs(1);
+
+    parser.add_argument("--udp-flow-limit")
+        .help("remote hosts a udp association keeps, the least recently used one is forgotten first")
+        .default_value((size_t)256)
+        .scan<'u', size_t>()
+        .nargs(1);
+
+    parser.add_argument("--udp-reassembly-size")
+        .help(
+            "bytes of fragmented udp datagrams held per worker until complete\n"
+            "0 = fragments are dropped")
+        .default_value((size_t)4194304)
+        .scan<'u', size_t>()
+        .nargs(1);
+
+    parser.add_argument("--workers")
+        .help(
+            "number of event loop threads, each one with its own listener\n"
+            "0 = one per CPU core")
+        .default_value((unsigned int)1)
+        .scan<'u', unsigned int>()
+        .nargs(1);
+
+    parser.add_argument("--handshake-timeout")
+        .help("seconds a client has to send the greeting and the command request (0 = none)")
+        .default_value((unsigned int)10)
+        .scan<'u', unsigned int>()
+        .nargs(1);
+
+    parser.add_argument("--auth-timeout")
+        .help("seconds a client has to authenticate (0 = none)")
+        .default_value((unsigned int)10)
+        .scan<'u', unsigned int>()
+        .nargs(1);
+
+    parser.add_argument("--dns-timeout")
+        .help("seconds to wait for a DNS response (0 = none)")
+        .default_value((unsigned int)10)
+        .scan<'u', unsigned int>()
+        .nargs(1);
+
+    parser.add_argument("--connect-timeout")
+        .help("seconds to wait for the remote connection (0 = none)")
+        .default_value((unsigned int)10)
+        .scan<'u', unsigned int>()
+        .nargs(1);
+
+    parser.add_argument("--idle-timeout")
+        .help("seconds an established session may stay without traffic (0 = none)")
+        .default_value((unsigned int)300)
+        .scan<'u', unsigned int>()
+        .nargs(1);
+
+    parser.add_argument("--udp-flow-timeout")
+        .help("seconds a remote host of a udp association is kept without traffic (0 = none)")
+        .default_value((unsigned int)120)
+        .scan<'u', unsigned int>()
+        .nargs(1);
+
+    parser.add_argument("--connect-attempt-delay")
+        .help("ms to wait before trying the next address of a remote (Happy Eyeballs)")
+        .default_value((unsigned int)250)
+        .scan<'u', unsigned int>()
+        .nargs(1);
+
+    parser.add_argument("--max-sessions")
+        .help(
+            "max number of simultaneous sessions, split between workers\n"
+            "0 = unlimited")
+        .default_value((size_t)0)
+        .scan<'u', size_t>()
+        .nargs(1);
+
 #if !SOCKSPP_DISABLE_LOGS
     parser.add_argument("--log-level")
         .help(
@@ -143,14 +328,45 @@ static inline sockspp::server::ServerParams parse_params(int argc, char* argv[])
 
     std::string listen_ip = parser.get<std::string>("--listen-ip");
     uint16_t listen_port = parser.get<uint16_t>("--listen-port");
+    unsigned int listen_backlog = parser.get<unsigned int>("--listen-backlog");
+    size_t accept_batch_size = parser.get<size_t>("--accept-batch-size");
+    unsigned int tcp_defer_accept = parser.get<unsigned int>("--tcp-defer-accept");
     std::string username = parser.get<std::string>("--username");
     std::string password = parser.get<std::string>("--password");
     std::string dns_ip = parser.get<std::string>("--dns-ip");
     uint16_t dns_port = parser.get<uint16_t>("--dns-port");
+    size_t dns_cache_size = parser.get<size_t>("--dns-cache-size");
+    unsigned int dns_negative_ttl = parser.get<unsigned int>("--dns-negative-ttl");
+    std::string dns_cache_file = parser.get<std::string>("--dns-cache-file");
+    unsigned int dns_cache_save_interval = parser.get<unsigned int>("--dns-cache-save-interval");
+    unsigned int dns_refresh_hits = parser.get<unsigned int>("--dns-refresh-hits");
+    unsigned int dns_refresh_rate = parser.get<unsigned int>("--dns-refresh-rate");
+    uint16_t dns_udp_payload_size = parser.get<uint16_t>("--dns-udp-payload-size");
+    std::string hosts_file = parser.get<std::string>("--hosts-file");
+    bool system_hosts = !parser.get<bool>("--no-system-hosts");
     bool client_tcp_nodelay = parser.get<bool>("--client-tcp-nodelay");
     bool client_tcp_keepalive = parser.get<bool>("--client-tcp-keepalive");
     bool remote_tcp_nodelay = parser.get<bool>("--remote-tcp-nodelay");
     bool remote_tcp_keepalive = parser.get<bool>("--remote-tcp-keepalive");
+    bool splice_relay = parser.get<bool>("--splice");
+    size_t relay_buffer_size = parser.get<size_t>("--relay-buffer-size");
+    size_t relay_high_watermark = parser.get<size_t>("--relay-high-watermark");
+    size_t relay_low_watermark = parser.get<size_t>("--relay-low-watermark");
+    size_t udp_batch_size = parser.get<size_t>("--udp-batch-size");
+    bool udp_offload = !parser.get<bool>("--no-udp-offload");
+    bool udp_shared_port = parser.get<bool>("--udp-shared-port");
+    size_t udp_egress_sockets = parser.get<size_t>("--udp-egress-sockets");
+    size_t udp_flow_limit = parser.get<size_t>("--udp-flow-limit");
+    size_t udp_reassembly_size = parser.get<size_t>("--udp-reassembly-size");
+    unsigned int workers = parser.get<unsigned int>("--workers");
+    size_t max_sessions = parser.get<size_t>("--max-sessions");
+    unsigned int handshake_timeout = parser.get<unsigned int>("--handshake-timeout");
+    unsigned int auth_timeout = parser.get<unsigned int>("--auth-timeout");
+    unsigned int dns_timeout = parser.get<unsigned int>("--dns-timeout");
+    unsigned int connect_timeout = parser.get<unsigned int>("--connect-timeout");
+    unsigned int idle_timeout = parser.get<unsigned int>("--idle-timeout");
+    unsigned int udp_flow_timeout = parser.get<unsigned int>("--udp-flow-timeout");
+    unsigned int connect_attempt_delay = parser.get<unsigned int>("--connect-attempt-delay");
 
 #if !SOCKSPP_DISABLE_LOGS
     std::string log_level_str = parser.get<std::string>("--log-level");
@@ -180,14 +396,45 @@ static inline sockspp::server::ServerParams parse_params(int argc, char* argv[])
     return sockspp::server::ServerParams{
         .listen_ip = listen_ip,
         .listen_port = listen_port,
+        .listen_backlog = listen_backlog,
+        .accept_batch_size = accept_batch_size,
+        .tcp_defer_accept = tcp_defer_accept,
         .username = username,
         .password = password,
         .dns_ip = dns_ip,
         .dns_port = dns_port,
+        .dns_cache_size = dns_cache_size,
+        .dns_negative_ttl = dns_negative_ttl,
+        .dns_cache_file = dns_cache_file,
+        .dns_cache_save_interval = dns_cache_save_interval,
+        .dns_refresh_hits = dns_refresh_hits,
+        .dns_refresh_rate = dns_refresh_rate,
+        .dns_udp_payload_size = dns_udp_payload_size,
+        .hosts_file = hosts_file,
+        .system_hosts = system_hosts,
         .client_tcp_nodelay = client_tcp_nodelay,
         .client_tcp_keepalive = client_tcp_keepalive,
         .remote_tcp_nodelay = remote_tcp_nodelay,
-        .remote_tcp_keepalive = remote_tcp_keepalive
+        .remote_tcp_keepalive = remote_tcp_keepalive,
+        .splice_relay = splice_relay,
+        .relay_buffer_size = relay_buffer_size,
+        .relay_high_watermark = relay_high_watermark,
+        .relay_low_watermark = relay_low_watermark,
+        .udp_batch_size = udp_batch_size,
+        .udp_offload = udp_offload,
+        .udp_shared_port = udp_shared_port,
+        .udp_egress_sockets = udp_egress_sockets,
+        .udp_flow_limit = udp_flow_limit,
+        .udp_reassembly_size = udp_reassembly_size,
+        .workers = workers,
+        .max_sessions = max_sessions,
+        .handshake_timeout = handshake_timeout,
+        .auth_timeout = auth_timeout,
+        .dns_timeout = dns_timeout,
+        .connect_timeout = connect_timeout,
+        .idle_timeout = idle_timeout,
+        .udp_flow_timeout = udp_flow_timeout,
+        .connect_attempt_delay = connect_attempt_delay
     };
 }
 